@@ -1,16 +1,28 @@
 #include "matrix_utils.h"
 #include "mult_algos.h"
 #include <chrono>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 
 using namespace std;
 using namespace std::chrono;
 
+BlockSizes tiles = default_block_sizes();
+
+Matrix mult_tiled(ConstMatrixView A, ConstMatrixView B) {
+  return mult_standard_tiled(A, B, tiles);
+}
+
+Matrix mult_tiled_simd(ConstMatrixView A, ConstMatrixView B) {
+  return mult_standard_simd(A, B, tiles, detected_simd_level());
+}
+
 void benchmark(int n1, int m1, int m2, ofstream &fout, int repeats = 100) {
   Matrix A = random_matrix(n1, m1);
   Matrix B = random_matrix(m1, m2);
-  auto measure = [&](Matrix (*func)(const Matrix &, const Matrix &),
+  auto measure = [&](Matrix (*func)(ConstMatrixView, ConstMatrixView),
                      const string &name) {
     double total_time = 0;
     for (int i = 0; i < repeats; ++i) {
@@ -25,11 +37,25 @@ void benchmark(int n1, int m1, int m2, ofstream &fout, int repeats = 100) {
     fout << n1 << "," << name << "," << avg_time << "\n";
   };
   measure(mult_standard, "Standard");
+  measure(mult_tiled, "Standard_Tiled");
+  measure(mult_tiled_simd, "Standard_SIMD");
   measure(mult_vinograd, "Vinograd");
   measure(mult_vinograd_opt, "Vinograd_Opt");
+  measure(mult_vinograd_packed, "Vinograd_Packed");
+  measure(mult_vinograd_simd, "Vinograd_SIMD");
 }
 
-int main() {
+int main(int argc, char **argv) {
+  for (int i = 1; i < argc; ++i) {
+    if (strncmp(argv[i], "--block=", 8) != 0 ||
+        sscanf(argv[i] + 8, "%dx%d", &tiles.depth, &tiles.cols) != 2 ||
+        tiles.depth <= 0 || tiles.cols <= 0) {
+      cerr << "Использование: " << argv[0] << " [--block=ГЛУБИНАxСТОЛБЦЫ]\n";
+      return 1;
+    }
+  }
+  cout << "Блоки Standard_Tiled: " << tiles.depth << "x" << tiles.cols
+       << ", SIMD: " << simd_level_name(detected_simd_level()) << "\n";
   int choice;
   cout
       << "Выберите режим:\n1. Ручной ввод\n2. Автоматический замер времени\n> ";
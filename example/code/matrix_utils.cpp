@@ -1,7 +1,84 @@
 #include "matrix_utils.h"
+#include <algorithm>
+#include <cstring>
+#include <new>
 #include <random>
+#include <stdexcept>
+#include <utility>
 
-Matrix make_matrix(int n, int m) { return Matrix(n, std::vector<int>(m, 0)); }
+Matrix::Matrix(int rows, int cols) : rows_(rows), cols_(cols) {
+  const int per_line = kAlignment / sizeof(int);
+  stride_ = (cols + per_line - 1) / per_line * per_line;
+  size_t bytes = (size_t)rows_ * stride_ * sizeof(int);
+  if (bytes == 0)
+    return;
+  data_ = static_cast<int *>(std::aligned_alloc(kAlignment, bytes));
+  if (data_ == nullptr)
+    throw std::bad_alloc();
+  std::memset(data_, 0, bytes);
+}
+
+Matrix::Matrix(std::initializer_list<std::initializer_list<int>> rows)
+    : Matrix(rows.size(), rows.size() == 0 ? 0 : rows.begin()->size()) {
+  int i = 0;
+  for (const auto &row : rows) {
+    if ((int)row.size() != cols_)
+      throw std::invalid_argument("matrix rows differ in length");
+    std::copy(row.begin(), row.end(), (*this)[i++]);
+  }
+}
+
+Matrix::Matrix(const NestedMatrix &nested)
+    : Matrix(nested.size(), nested.empty() ? 0 : nested[0].size()) {
+  for (int i = 0; i < rows_; ++i) {
+    if ((int)nested[i].size() != cols_)
+      throw std::invalid_argument("matrix rows differ in length");
+    std::copy(nested[i].begin(), nested[i].end(), (*this)[i]);
+  }
+}
+
+Matrix::Matrix(ConstMatrixView view) : Matrix(view.rows(), view.cols()) {
+  for (int i = 0; i < rows_; ++i)
+    std::copy(view[i], view[i] + cols_, (*this)[i]);
+}
+
+Matrix::Matrix(const Matrix &other) : Matrix(other.rows_, other.cols_) {
+  if (data_ != nullptr)
+    std::memcpy(data_, other.data_, (size_t)rows_ * stride_ * sizeof(int));
+}
+
+Matrix::Matrix(Matrix &&other) noexcept
+    : data_(other.data_), rows_(other.rows_), cols_(other.cols_),
+      stride_(other.stride_) {
+  other.data_ = nullptr;
+  other.rows_ = other.cols_ = other.stride_ = 0;
+}
+
+Matrix &Matrix::operator=(Matrix other) noexcept {
+  std::swap(data_, other.data_);
+  std::swap(rows_, other.rows_);
+  std::swap(cols_, other.cols_);
+  std::swap(stride_, other.stride_);
+  return *this;
+}
+
+NestedMatrix Matrix::to_nested() const {
+  NestedMatrix nested(rows_);
+  for (int i = 0; i < rows_; ++i)
+    nested[i].assign((*this)[i], (*this)[i] + cols_);
+  return nested;
+}
+
+bool operator==(const Matrix &a, const Matrix &b) {
+  if (a.rows_ != b.rows_ || a.cols_ != b.cols_)
+    return false;
+  for (int i = 0; i < a.rows_; ++i)
+    if (!std::equal(a[i], a[i] + a.cols_, b[i]))
+      return false;
+  return true;
+}
+
+Matrix make_matrix(int n, int m) { return Matrix(n, m); }
 
 Matrix random_matrix(int n, int m) {
   Matrix mat = make_matrix(n, m);
@@ -23,10 +100,10 @@ Matrix input_matrix(int n, int m) {
   return mat;
 }
 
-void print_matrix(const Matrix &mat) {
-  for (const auto &row : mat) {
-    for (int val : row)
-      std::cout << val << " ";
+void print_matrix(ConstMatrixView mat) {
+  for (int i = 0; i < mat.rows(); ++i) {
+    for (int j = 0; j < mat.cols(); ++j)
+      std::cout << mat[i][j] << " ";
     std::cout << "\n";
   }
 }
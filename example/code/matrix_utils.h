@@ -1,8 +1,87 @@
 #pragma once
+#include <cstdlib>
+#include <initializer_list>
 #include <iostream>
 #include <vector>
 
-typedef std::vector<std::vector<int>> Matrix;
+typedef std::vector<std::vector<int>> NestedMatrix;
+
+// Non-owning rows x cols window into row-major storage; row i starts at
+// data + i * stride. T is int or const int.
+template <typename T> class BasicMatrixView {
+public:
+  BasicMatrixView(T *data, int rows, int cols, int stride)
+      : data_(data), rows_(rows), cols_(cols), stride_(stride) {}
+  template <typename U>
+  BasicMatrixView(const BasicMatrixView<U> &other)
+      : BasicMatrixView(other.data(), other.rows(), other.cols(),
+                        other.stride()) {}
+
+  int rows() const { return rows_; }
+  int cols() const { return cols_; }
+  int stride() const { return stride_; }
+  T *data() const { return data_; }
+  T *operator[](int i) const { return data_ + (size_t)i * stride_; }
+
+  BasicMatrixView block(int row, int col, int rows, int cols) const {
+    return BasicMatrixView(data_ + (size_t)row * stride_ + col, rows, cols,
+                           stride_);
+  }
+
+private:
+  T *data_;
+  int rows_, cols_, stride_;
+};
+
+typedef BasicMatrixView<int> MatrixView;
+typedef BasicMatrixView<const int> ConstMatrixView;
+
+// Row-major matrix in one 64-byte aligned allocation. Rows are padded to a
+// multiple of 16 ints, so every row starts on a cache line and SIMD loads of
+// a row never split one; the padding is zero.
+class Matrix {
+public:
+  static const int kAlignment = 64;
+
+  Matrix() = default;
+  Matrix(int rows, int cols);
+  Matrix(std::initializer_list<std::initializer_list<int>> rows);
+  Matrix(const NestedMatrix &nested);
+  explicit Matrix(ConstMatrixView view);
+  Matrix(const Matrix &other);
+  Matrix(Matrix &&other) noexcept;
+  Matrix &operator=(Matrix other) noexcept;
+  ~Matrix() { std::free(data_); }
+
+  int rows() const { return rows_; }
+  int cols() const { return cols_; }
+  int stride() const { return stride_; }
+  int *data() { return data_; }
+  const int *data() const { return data_; }
+  int *operator[](int i) { return data_ + (size_t)i * stride_; }
+  const int *operator[](int i) const { return data_ + (size_t)i * stride_; }
+
+  MatrixView view() { return MatrixView(data_, rows_, cols_, stride_); }
+  ConstMatrixView view() const {
+    return ConstMatrixView(data_, rows_, cols_, stride_);
+  }
+  operator ConstMatrixView() const { return view(); }
+  MatrixView block(int row, int col, int rows, int cols) {
+    return view().block(row, col, rows, cols);
+  }
+  ConstMatrixView block(int row, int col, int rows, int cols) const {
+    return view().block(row, col, rows, cols);
+  }
+
+  NestedMatrix to_nested() const;
+
+  friend bool operator==(const Matrix &a, const Matrix &b);
+  friend bool operator!=(const Matrix &a, const Matrix &b) { return !(a == b); }
+
+private:
+  int *data_ = nullptr;
+  int rows_ = 0, cols_ = 0, stride_ = 0;
+};
 
 Matrix make_matrix(int n, int m);
 
@@ -10,4 +89,4 @@ Matrix random_matrix(int n, int m);
 
 Matrix input_matrix(int n, int m);
 
-void print_matrix(const Matrix &mat);
+void print_matrix(ConstMatrixView mat);
@@ -1,9 +1,56 @@
 #include "mult_algos.h"
+#include <algorithm>
+#include <fstream>
+#include <string>
 #include <vector>
 
-Matrix mult_standard(const Matrix &A, const Matrix &B) {
-  int n = A.size(), m = B[0].size(), k = B.size();
-  Matrix C(n, std::vector<int>(m, 0));
+namespace {
+
+// Size in bytes of the level-`level` data or unified cache of cpu0, or 0.
+long cache_size(int level) {
+  for (int index = 0;; ++index) {
+    std::string dir = "/sys/devices/system/cpu/cpu0/cache/index" +
+                      std::to_string(index) + "/";
+    std::ifstream level_file(dir + "level");
+    int found_level = 0;
+    if (!(level_file >> found_level))
+      return 0;
+    std::string type, size;
+    std::ifstream(dir + "type") >> type;
+    std::ifstream(dir + "size") >> size;
+    if (found_level != level || type == "Instruction" || size.empty())
+      continue;
+    long bytes = std::stol(size);
+    if (size.back() == 'K')
+      bytes <<= 10;
+    else if (size.back() == 'M')
+      bytes <<= 20;
+    return bytes;
+  }
+}
+
+} // namespace
+
+BlockSizes default_block_sizes() {
+  static const BlockSizes sizes = [] {
+    long l1 = cache_size(1), l2 = cache_size(2);
+    if (l1 <= 0)
+      l1 = 32 << 10;
+    if (l2 <= 0)
+      l2 = 256 << 10;
+    // A row segment of C and one of B take half of L1; the depth x cols
+    // panel of B, reused for every row of A, takes half of L2.
+    const int line = Matrix::kAlignment / sizeof(int);
+    int cols = std::max<long>(line, l1 / (4 * sizeof(int)) / line * line);
+    int depth = std::max<long>(1, l2 / (2 * sizeof(int) * cols));
+    return BlockSizes{depth, cols};
+  }();
+  return sizes;
+}
+
+Matrix mult_standard(ConstMatrixView A, ConstMatrixView B) {
+  int n = A.rows(), m = B.cols(), k = B.rows();
+  Matrix C(n, m);
   for (int i = 0; i < n; ++i)
     for (int j = 0; j < m; ++j)
       for (int t = 0; t < k; ++t)
@@ -11,9 +58,37 @@ Matrix mult_standard(const Matrix &A, const Matrix &B) {
   return C;
 }
 
-Matrix mult_vinograd(const Matrix &A, const Matrix &B) {
-  int n = A.size(), m = B[0].size(), k = B.size();
-  Matrix C(n, std::vector<int>(m, 0));
+Matrix mult_standard_tiled(ConstMatrixView A, ConstMatrixView B) {
+  return mult_standard_tiled(A, B, default_block_sizes());
+}
+
+Matrix mult_standard_tiled(ConstMatrixView A, ConstMatrixView B,
+                           BlockSizes blocks) {
+  int n = A.rows(), m = B.cols(), k = B.rows();
+  Matrix C(n, m);
+  int depth = std::max(1, blocks.depth), cols = std::max(1, blocks.cols);
+  for (int jj = 0; jj < m; jj += cols) {
+    int j_end = std::min(m, jj + cols);
+    for (int tt = 0; tt < k; tt += depth) {
+      int t_end = std::min(k, tt + depth);
+      for (int i = 0; i < n; ++i) {
+        const int *a = A[i];
+        int *c = C[i];
+        for (int t = tt; t < t_end; ++t) {
+          int a_t = a[t];
+          const int *b = B[t];
+          for (int j = jj; j < j_end; ++j)
+            c[j] += a_t * b[j];
+        }
+      }
+    }
+  }
+  return C;
+}
+
+Matrix mult_vinograd(ConstMatrixView A, ConstMatrixView B) {
+  int n = A.rows(), m = B.cols(), k = B.rows();
+  Matrix C(n, m);
   std::vector<int> row_factor(n, 0), col_factor(m, 0);
   for (int i = 0; i < n; ++i)
     for (int t = 0; t < k / 2; ++t)
@@ -37,9 +112,9 @@ Matrix mult_vinograd(const Matrix &A, const Matrix &B) {
   return C;
 }
 
-Matrix mult_vinograd_opt(const Matrix &A, const Matrix &B) {
-  int n = A.size(), m = B[0].size(), k = B.size();
-  Matrix C(n, std::vector<int>(m, 0));
+Matrix mult_vinograd_opt(ConstMatrixView A, ConstMatrixView B) {
+  int n = A.rows(), m = B.cols(), k = B.rows();
+  Matrix C(n, m);
   std::vector<int> row_factor(n, 0), col_factor(m, 0);
   int k2 = k / 2;
   for (int i = 0; i < n; ++i) {
@@ -55,19 +130,81 @@ Matrix mult_vinograd_opt(const Matrix &A, const Matrix &B) {
     col_factor[j] = sum;
   }
   for (int i = 0; i < n; ++i) {
+    const int *a = A[i];
+    int *c = C[i];
     for (int j = 0; j < m; ++j) {
       int temp = -row_factor[i] - col_factor[j];
       for (int t = 0; t < k2; ++t)
-        temp +=
-            (A[i][2 * t] + B[2 * t + 1][j]) * (A[i][2 * t + 1] + B[2 * t][j]);
-      C[i][j] = temp;
+        temp += (a[2 * t] + B[2 * t + 1][j]) * (a[2 * t + 1] + B[2 * t][j]);
+      c[j] = temp;
     }
   }
   if (k % 2 == 1) {
     int last = k - 1;
-    for (int i = 0; i < n; ++i)
+    const int *b = B[last];
+    for (int i = 0; i < n; ++i) {
+      int a = A[i][last];
+      int *c = C[i];
+      for (int j = 0; j < m; ++j)
+        c[j] += a * b[j];
+    }
+  }
+  return C;
+}
+
+Matrix pack_vinograd(ConstMatrixView B) {
+  int k2 = B.rows() / 2, m = B.cols();
+  Matrix P(m, 2 * k2);
+  for (int t = 0; t < k2; ++t) {
+    const int *b0 = B[2 * t], *b1 = B[2 * t + 1];
+    for (int j = 0; j < m; ++j) {
+      P[j][2 * t] = b1[j];
+      P[j][2 * t + 1] = b0[j];
+    }
+  }
+  return P;
+}
+
+Matrix mult_vinograd_packed(ConstMatrixView A, ConstMatrixView B) {
+  int n = A.rows(), m = B.cols(), k = B.rows();
+  Matrix C(n, m);
+  Matrix P = pack_vinograd(B);
+  std::vector<int> row_factor(n, 0), col_factor(m, 0);
+  int k2 = k / 2;
+  for (int i = 0; i < n; ++i) {
+    const int *a = A[i];
+    int sum = 0;
+    for (int t = 0; t < k2; ++t)
+      sum += a[2 * t] * a[2 * t + 1];
+    row_factor[i] = sum;
+  }
+  for (int j = 0; j < m; ++j) {
+    const int *p = P[j];
+    int sum = 0;
+    for (int t = 0; t < k2; ++t)
+      sum += p[2 * t] * p[2 * t + 1];
+    col_factor[j] = sum;
+  }
+  for (int i = 0; i < n; ++i) {
+    const int *a = A[i];
+    int *c = C[i];
+    for (int j = 0; j < m; ++j) {
+      const int *p = P[j];
+      int temp = -row_factor[i] - col_factor[j];
+      for (int t = 0; t < k2; ++t)
+        temp += (a[2 * t] + p[2 * t]) * (a[2 * t + 1] + p[2 * t + 1]);
+      c[j] = temp;
+    }
+  }
+  if (k % 2 == 1) {
+    int last = k - 1;
+    const int *b = B[last];
+    for (int i = 0; i < n; ++i) {
+      int a = A[i][last];
+      int *c = C[i];
       for (int j = 0; j < m; ++j)
-        C[i][j] += A[i][last] * B[last][j];
+        c[j] += a * b[j];
+    }
   }
   return C;
 }
@@ -1,8 +1,54 @@
 #pragma once
 #include "matrix_utils.h"
 
-Matrix mult_standard(const Matrix &A, const Matrix &B);
+// Tile of the cache-blocked multiplication: `depth` rows of B by `cols`
+// columns of B and C.
+struct BlockSizes {
+  int depth;
+  int cols;
+};
 
-Matrix mult_vinograd(const Matrix &A, const Matrix &B);
+// Block sizes for this machine's L1d and L2, read once from
+// /sys/devices/system/cpu/cpu0/cache (32K and 256K if unavailable).
+BlockSizes default_block_sizes();
 
-Matrix mult_vinograd_opt(const Matrix &A, const Matrix &B);
+Matrix mult_standard(ConstMatrixView A, ConstMatrixView B);
+
+// i-k-j standard multiplication over BlockSizes tiles.
+Matrix mult_standard_tiled(ConstMatrixView A, ConstMatrixView B);
+Matrix mult_standard_tiled(ConstMatrixView A, ConstMatrixView B,
+                           BlockSizes blocks);
+
+Matrix mult_vinograd(ConstMatrixView A, ConstMatrixView B);
+
+Matrix mult_vinograd_opt(ConstMatrixView A, ConstMatrixView B);
+
+// B for the Winograd inner loop: row j holds column j of B with each pair of
+// rows swapped, P[j][2t] = B[2t+1][j] and P[j][2t+1] = B[2t][j]. An odd last
+// row of B is left out.
+Matrix pack_vinograd(ConstMatrixView B);
+
+// mult_vinograd_opt over pack_vinograd(B): the inner loop and the column
+// factors read both operands sequentially.
+Matrix mult_vinograd_packed(ConstMatrixView A, ConstMatrixView B);
+
+// Widest SIMD level the kernels below use: 8 (AVX2) or 16 (AVX-512) int32
+// columns per instruction. Results are bit-identical at every level.
+enum class SimdLevel { kScalar, kAvx2, kAvx512 };
+
+// Best level this CPU supports, from __builtin_cpu_supports.
+SimdLevel detected_simd_level();
+const char *simd_level_name(SimdLevel level);
+
+// mult_standard_tiled with vectorised inner loops. Levels above
+// detected_simd_level() fall back to the best supported one; kScalar runs
+// mult_standard_tiled itself.
+Matrix mult_standard_simd(ConstMatrixView A, ConstMatrixView B);
+Matrix mult_standard_simd(ConstMatrixView A, ConstMatrixView B,
+                          BlockSizes blocks, SimdLevel level);
+
+// Winograd over 8 or 16 output columns at once, reading rows of B directly;
+// kScalar runs mult_vinograd_packed.
+Matrix mult_vinograd_simd(ConstMatrixView A, ConstMatrixView B);
+Matrix mult_vinograd_simd(ConstMatrixView A, ConstMatrixView B,
+                          SimdLevel level);
@@ -0,0 +1,337 @@
+#include "mult_algos.h"
+#include <algorithm>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MULT_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Sums of B[2t][j] * B[2t+1][j], accumulated row by row so the loop streams.
+std::vector<int> vinograd_col_factor(ConstMatrixView B) {
+  int m = B.cols(), k2 = B.rows() / 2;
+  std::vector<int> col_factor(m, 0);
+  for (int t = 0; t < k2; ++t) {
+    const int *b0 = B[2 * t], *b1 = B[2 * t + 1];
+    for (int j = 0; j < m; ++j)
+      col_factor[j] += b0[j] * b1[j];
+  }
+  return col_factor;
+}
+
+std::vector<int> vinograd_row_factor(ConstMatrixView A, int k2) {
+  std::vector<int> row_factor(A.rows(), 0);
+  for (int i = 0; i < A.rows(); ++i) {
+    const int *a = A[i];
+    int sum = 0;
+    for (int t = 0; t < k2; ++t)
+      sum += a[2 * t] * a[2 * t + 1];
+    row_factor[i] = sum;
+  }
+  return row_factor;
+}
+
+// C[i][j] of the Winograd product for one column, as in mult_vinograd_opt.
+int vinograd_cell(const int *a, ConstMatrixView B, int j, int k2, int init) {
+  int temp = init;
+  for (int t = 0; t < k2; ++t)
+    temp += (a[2 * t] + B[2 * t + 1][j]) * (a[2 * t + 1] + B[2 * t][j]);
+  return temp;
+}
+
+void vinograd_odd_row(ConstMatrixView A, ConstMatrixView B, MatrixView C) {
+  int last = B.rows() - 1;
+  const int *b = B[last];
+  for (int i = 0; i < A.rows(); ++i) {
+    int a = A[i][last];
+    int *c = C[i];
+    for (int j = 0; j < C.cols(); ++j)
+      c[j] += a * b[j];
+  }
+}
+
+#ifdef MULT_SIMD_X86
+
+// Both kernels keep a strip of one C row in registers while running down
+// the rows of B, so every load of B is a contiguous vector of a B row.
+
+__attribute__((target("avx2"))) void
+standard_avx2(ConstMatrixView A, ConstMatrixView B, MatrixView C,
+              BlockSizes blocks) {
+  int n = A.rows(), m = B.cols(), k = B.rows();
+  for (int jj = 0; jj < m; jj += blocks.cols) {
+    int j_end = std::min(m, jj + blocks.cols);
+    for (int tt = 0; tt < k; tt += blocks.depth) {
+      int t_end = std::min(k, tt + blocks.depth);
+      for (int i = 0; i < n; ++i) {
+        const int *a = A[i];
+        int *c = C[i];
+        int j = jj;
+        for (; j + 32 <= j_end; j += 32) {
+          __m256i c0 = _mm256_loadu_si256((const __m256i *)(c + j));
+          __m256i c1 = _mm256_loadu_si256((const __m256i *)(c + j + 8));
+          __m256i c2 = _mm256_loadu_si256((const __m256i *)(c + j + 16));
+          __m256i c3 = _mm256_loadu_si256((const __m256i *)(c + j + 24));
+          for (int t = tt; t < t_end; ++t) {
+            __m256i a_t = _mm256_set1_epi32(a[t]);
+            const int *b = B[t] + j;
+            c0 = _mm256_add_epi32(
+                c0, _mm256_mullo_epi32(
+                        a_t, _mm256_loadu_si256((const __m256i *)b)));
+            c1 = _mm256_add_epi32(
+                c1, _mm256_mullo_epi32(
+                        a_t, _mm256_loadu_si256((const __m256i *)(b + 8))));
+            c2 = _mm256_add_epi32(
+                c2, _mm256_mullo_epi32(
+                        a_t, _mm256_loadu_si256((const __m256i *)(b + 16))));
+            c3 = _mm256_add_epi32(
+                c3, _mm256_mullo_epi32(
+                        a_t, _mm256_loadu_si256((const __m256i *)(b + 24))));
+          }
+          _mm256_storeu_si256((__m256i *)(c + j), c0);
+          _mm256_storeu_si256((__m256i *)(c + j + 8), c1);
+          _mm256_storeu_si256((__m256i *)(c + j + 16), c2);
+          _mm256_storeu_si256((__m256i *)(c + j + 24), c3);
+        }
+        for (; j + 8 <= j_end; j += 8) {
+          __m256i c0 = _mm256_loadu_si256((const __m256i *)(c + j));
+          for (int t = tt; t < t_end; ++t)
+            c0 = _mm256_add_epi32(
+                c0, _mm256_mullo_epi32(
+                        _mm256_set1_epi32(a[t]),
+                        _mm256_loadu_si256((const __m256i *)(B[t] + j))));
+          _mm256_storeu_si256((__m256i *)(c + j), c0);
+        }
+        for (; j < j_end; ++j) {
+          int sum = c[j];
+          for (int t = tt; t < t_end; ++t)
+            sum += a[t] * B[t][j];
+          c[j] = sum;
+        }
+      }
+    }
+  }
+}
+
+__attribute__((target("avx512f"))) void
+standard_avx512(ConstMatrixView A, ConstMatrixView B, MatrixView C,
+                BlockSizes blocks) {
+  int n = A.rows(), m = B.cols(), k = B.rows();
+  for (int jj = 0; jj < m; jj += blocks.cols) {
+    int j_end = std::min(m, jj + blocks.cols);
+    for (int tt = 0; tt < k; tt += blocks.depth) {
+      int t_end = std::min(k, tt + blocks.depth);
+      for (int i = 0; i < n; ++i) {
+        const int *a = A[i];
+        int *c = C[i];
+        int j = jj;
+        for (; j + 64 <= j_end; j += 64) {
+          __m512i c0 = _mm512_loadu_si512(c + j);
+          __m512i c1 = _mm512_loadu_si512(c + j + 16);
+          __m512i c2 = _mm512_loadu_si512(c + j + 32);
+          __m512i c3 = _mm512_loadu_si512(c + j + 48);
+          for (int t = tt; t < t_end; ++t) {
+            __m512i a_t = _mm512_set1_epi32(a[t]);
+            const int *b = B[t] + j;
+            c0 = _mm512_add_epi32(c0,
+                                  _mm512_mullo_epi32(a_t, _mm512_loadu_si512(b)));
+            c1 = _mm512_add_epi32(
+                c1, _mm512_mullo_epi32(a_t, _mm512_loadu_si512(b + 16)));
+            c2 = _mm512_add_epi32(
+                c2, _mm512_mullo_epi32(a_t, _mm512_loadu_si512(b + 32)));
+            c3 = _mm512_add_epi32(
+                c3, _mm512_mullo_epi32(a_t, _mm512_loadu_si512(b + 48)));
+          }
+          _mm512_storeu_si512(c + j, c0);
+          _mm512_storeu_si512(c + j + 16, c1);
+          _mm512_storeu_si512(c + j + 32, c2);
+          _mm512_storeu_si512(c + j + 48, c3);
+        }
+        // Masked loads never touch the columns past the strip, so views
+        // into larger matrices are safe.
+        for (; j < j_end; j += 16) {
+          __mmask16 mask = j + 16 <= j_end
+                               ? (__mmask16)0xFFFF
+                               : (__mmask16)((1u << (j_end - j)) - 1);
+          __m512i c0 = _mm512_maskz_loadu_epi32(mask, c + j);
+          for (int t = tt; t < t_end; ++t)
+            c0 = _mm512_add_epi32(
+                c0, _mm512_mullo_epi32(_mm512_set1_epi32(a[t]),
+                                       _mm512_maskz_loadu_epi32(mask, B[t] + j)));
+          _mm512_mask_storeu_epi32(c + j, mask, c0);
+        }
+      }
+    }
+  }
+}
+
+__attribute__((target("avx2"))) void
+vinograd_avx2(ConstMatrixView A, ConstMatrixView B, MatrixView C,
+              const std::vector<int> &row_factor,
+              const std::vector<int> &col_factor) {
+  int n = A.rows(), m = B.cols(), k2 = B.rows() / 2;
+  for (int i = 0; i < n; ++i) {
+    const int *a = A[i];
+    int *c = C[i];
+    __m256i rf = _mm256_set1_epi32(row_factor[i]);
+    int j = 0;
+    for (; j + 16 <= m; j += 16) {
+      __m256i c0 = _mm256_sub_epi32(
+          _mm256_setzero_si256(),
+          _mm256_add_epi32(
+              rf, _mm256_loadu_si256((const __m256i *)(&col_factor[j]))));
+      __m256i c1 = _mm256_sub_epi32(
+          _mm256_setzero_si256(),
+          _mm256_add_epi32(
+              rf, _mm256_loadu_si256((const __m256i *)(&col_factor[j + 8]))));
+      for (int t = 0; t < k2; ++t) {
+        __m256i a0 = _mm256_set1_epi32(a[2 * t]);
+        __m256i a1 = _mm256_set1_epi32(a[2 * t + 1]);
+        const int *b0 = B[2 * t] + j, *b1 = B[2 * t + 1] + j;
+        c0 = _mm256_add_epi32(
+            c0, _mm256_mullo_epi32(
+                    _mm256_add_epi32(a0, _mm256_loadu_si256((const __m256i *)b1)),
+                    _mm256_add_epi32(a1,
+                                     _mm256_loadu_si256((const __m256i *)b0))));
+        c1 = _mm256_add_epi32(
+            c1, _mm256_mullo_epi32(
+                    _mm256_add_epi32(
+                        a0, _mm256_loadu_si256((const __m256i *)(b1 + 8))),
+                    _mm256_add_epi32(
+                        a1, _mm256_loadu_si256((const __m256i *)(b0 + 8)))));
+      }
+      _mm256_storeu_si256((__m256i *)(c + j), c0);
+      _mm256_storeu_si256((__m256i *)(c + j + 8), c1);
+    }
+    for (; j < m; ++j)
+      c[j] = vinograd_cell(a, B, j, k2, -row_factor[i] - col_factor[j]);
+  }
+}
+
+__attribute__((target("avx512f"))) void
+vinograd_avx512(ConstMatrixView A, ConstMatrixView B, MatrixView C,
+                const std::vector<int> &row_factor,
+                const std::vector<int> &col_factor) {
+  int n = A.rows(), m = B.cols(), k2 = B.rows() / 2;
+  for (int i = 0; i < n; ++i) {
+    const int *a = A[i];
+    int *c = C[i];
+    __m512i rf = _mm512_set1_epi32(row_factor[i]);
+    int j = 0;
+    for (; j + 32 <= m; j += 32) {
+      __m512i c0 = _mm512_sub_epi32(
+          _mm512_setzero_si512(),
+          _mm512_add_epi32(rf, _mm512_loadu_si512(&col_factor[j])));
+      __m512i c1 = _mm512_sub_epi32(
+          _mm512_setzero_si512(),
+          _mm512_add_epi32(rf, _mm512_loadu_si512(&col_factor[j + 16])));
+      for (int t = 0; t < k2; ++t) {
+        __m512i a0 = _mm512_set1_epi32(a[2 * t]);
+        __m512i a1 = _mm512_set1_epi32(a[2 * t + 1]);
+        const int *b0 = B[2 * t] + j, *b1 = B[2 * t + 1] + j;
+        c0 = _mm512_add_epi32(
+            c0, _mm512_mullo_epi32(_mm512_add_epi32(a0, _mm512_loadu_si512(b1)),
+                                   _mm512_add_epi32(a1, _mm512_loadu_si512(b0))));
+        c1 = _mm512_add_epi32(
+            c1, _mm512_mullo_epi32(
+                    _mm512_add_epi32(a0, _mm512_loadu_si512(b1 + 16)),
+                    _mm512_add_epi32(a1, _mm512_loadu_si512(b0 + 16))));
+      }
+      _mm512_storeu_si512(c + j, c0);
+      _mm512_storeu_si512(c + j + 16, c1);
+    }
+    for (; j < m; j += 16) {
+      __mmask16 mask = j + 16 <= m ? (__mmask16)0xFFFF
+                                   : (__mmask16)((1u << (m - j)) - 1);
+      __m512i c0 = _mm512_sub_epi32(
+          _mm512_setzero_si512(),
+          _mm512_add_epi32(rf, _mm512_maskz_loadu_epi32(mask, &col_factor[j])));
+      for (int t = 0; t < k2; ++t) {
+        __m512i b0 = _mm512_maskz_loadu_epi32(mask, B[2 * t] + j);
+        __m512i b1 = _mm512_maskz_loadu_epi32(mask, B[2 * t + 1] + j);
+        c0 = _mm512_add_epi32(
+            c0, _mm512_mullo_epi32(
+                    _mm512_add_epi32(_mm512_set1_epi32(a[2 * t]), b1),
+                    _mm512_add_epi32(_mm512_set1_epi32(a[2 * t + 1]), b0)));
+      }
+      _mm512_mask_storeu_epi32(c + j, mask, c0);
+    }
+  }
+}
+
+#endif // MULT_SIMD_X86
+
+} // namespace
+
+SimdLevel detected_simd_level() {
+#ifdef MULT_SIMD_X86
+  static const SimdLevel level = __builtin_cpu_supports("avx512f")
+                                     ? SimdLevel::kAvx512
+                                 : __builtin_cpu_supports("avx2")
+                                     ? SimdLevel::kAvx2
+                                     : SimdLevel::kScalar;
+  return level;
+#else
+  return SimdLevel::kScalar;
+#endif
+}
+
+const char *simd_level_name(SimdLevel level) {
+  switch (level) {
+  case SimdLevel::kAvx512:
+    return "AVX-512";
+  case SimdLevel::kAvx2:
+    return "AVX2";
+  default:
+    return "scalar";
+  }
+}
+
+Matrix mult_standard_simd(ConstMatrixView A, ConstMatrixView B) {
+  return mult_standard_simd(A, B, default_block_sizes(),
+                            detected_simd_level());
+}
+
+Matrix mult_standard_simd(ConstMatrixView A, ConstMatrixView B,
+                          BlockSizes blocks, SimdLevel level) {
+  blocks.depth = std::max(1, blocks.depth);
+  blocks.cols = std::max(1, blocks.cols);
+  level = std::min(level, detected_simd_level());
+#ifdef MULT_SIMD_X86
+  if (level != SimdLevel::kScalar) {
+    Matrix C(A.rows(), B.cols());
+    if (level == SimdLevel::kAvx512)
+      standard_avx512(A, B, C.view(), blocks);
+    else
+      standard_avx2(A, B, C.view(), blocks);
+    return C;
+  }
+#endif
+  return mult_standard_tiled(A, B, blocks);
+}
+
+Matrix mult_vinograd_simd(ConstMatrixView A, ConstMatrixView B) {
+  return mult_vinograd_simd(A, B, detected_simd_level());
+}
+
+Matrix mult_vinograd_simd(ConstMatrixView A, ConstMatrixView B,
+                          SimdLevel level) {
+  level = std::min(level, detected_simd_level());
+#ifdef MULT_SIMD_X86
+  if (level != SimdLevel::kScalar) {
+    Matrix C(A.rows(), B.cols());
+    std::vector<int> row_factor = vinograd_row_factor(A, B.rows() / 2);
+    std::vector<int> col_factor = vinograd_col_factor(B);
+    if (level == SimdLevel::kAvx512)
+      vinograd_avx512(A, B, C.view(), row_factor, col_factor);
+    else
+      vinograd_avx2(A, B, C.view(), row_factor, col_factor);
+    if (B.rows() % 2 == 1)
+      vinograd_odd_row(A, B, C.view());
+    return C;
+  }
+#endif
+  return mult_vinograd_packed(A, B);
+}
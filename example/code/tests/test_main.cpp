@@ -1,5 +1,7 @@
 #include "../mult_algos.h"
+#include <cstdint>
 #include <iostream>
+#include <stdexcept>
 #include <vector>
 
 int main() {
@@ -16,5 +18,83 @@ int main() {
   bool ok3 = (mult_vinograd_opt(A, B) == expected);
   std::cout << (ok3 ? "TEST 3 PASSED\n" : "TEST 3 FAILED\n");
 
+  NestedMatrix nested_a = {{1, 2, 3}, {4, 5, 6}};
+  NestedMatrix nested_b = {{7, 8}, {9, 10}, {11, 12}};
+  Matrix odd_expected = {{58, 64}, {139, 154}};
+  Matrix odd_a = nested_a, odd_b = nested_b;
+  bool ok4 = mult_standard(odd_a, odd_b) == odd_expected &&
+             mult_vinograd(odd_a, odd_b) == odd_expected &&
+             mult_vinograd_opt(odd_a, odd_b) == odd_expected &&
+             odd_a.to_nested() == nested_a;
+  std::cout << (ok4 ? "TEST 4 PASSED\n" : "TEST 4 FAILED\n");
+
+  Matrix big = random_matrix(40, 40);
+  ConstMatrixView left = big.block(3, 5, 17, 21);
+  ConstMatrixView right = big.block(10, 0, 21, 33);
+  Matrix product = mult_standard(Matrix(left), Matrix(right));
+  bool ok5 = mult_standard(left, right) == product &&
+             mult_vinograd(left, right) == product &&
+             mult_vinograd_opt(left, right) == product;
+  for (int i = 0; i < big.rows(); ++i)
+    ok5 = ok5 && reinterpret_cast<uintptr_t>(big[i]) % Matrix::kAlignment == 0;
+  std::cout << (ok5 ? "TEST 5 PASSED\n" : "TEST 5 FAILED\n");
+
+  Matrix tall = random_matrix(37, 29), wide = random_matrix(29, 41);
+  Matrix tall_wide = mult_standard(tall, wide);
+  bool ok6 = mult_standard_tiled(tall, wide) == tall_wide &&
+             mult_standard_tiled(tall, wide, BlockSizes{7, 5}) == tall_wide &&
+             mult_standard_tiled(left, right, BlockSizes{4, 16}) == product &&
+             mult_standard_tiled(A, B, BlockSizes{1, 1}) == expected;
+  std::cout << (ok6 ? "TEST 6 PASSED\n" : "TEST 6 FAILED\n");
+
+  Matrix packed = pack_vinograd(Matrix{{1, 2}, {3, 4}, {5, 6}});
+  bool ok7 = packed == Matrix{{3, 1}, {4, 2}} &&
+             mult_vinograd_packed(A, B) == expected &&
+             mult_vinograd_packed(odd_a, odd_b) == odd_expected &&
+             mult_vinograd_packed(tall, wide) == tall_wide &&
+             mult_vinograd_packed(left, right) == product;
+  std::cout << (ok7 ? "TEST 7 PASSED\n" : "TEST 7 FAILED\n");
+
+  // Every SIMD level against the scalar kernels, with column tails, odd
+  // depths, strided views and negative entries.
+  Matrix negative = random_matrix(23, 71);
+  for (int i = 0; i < negative.rows(); ++i)
+    for (int j = 0; j < negative.cols(); ++j)
+      negative[i][j] -= 5;
+  Matrix square = random_matrix(67, 67);
+  bool ok8 = true;
+  for (SimdLevel level :
+       {SimdLevel::kScalar, SimdLevel::kAvx2, SimdLevel::kAvx512}) {
+    for (BlockSizes blocks : {default_block_sizes(), BlockSizes{5, 24}}) {
+      ok8 = ok8 &&
+            mult_standard_simd(tall, wide, blocks, level) == tall_wide &&
+            mult_standard_simd(left, right, blocks, level) == product &&
+            mult_standard_simd(negative, square, blocks, level) ==
+                mult_standard(negative, square) &&
+            mult_standard_simd(A, B, blocks, level) == expected;
+    }
+    ok8 = ok8 && mult_vinograd_simd(tall, wide, level) == tall_wide &&
+          mult_vinograd_simd(left, right, level) == product &&
+          mult_vinograd_simd(negative, square, level) ==
+              mult_vinograd_opt(negative, square) &&
+          mult_vinograd_simd(square, square, level) ==
+              mult_vinograd_opt(square, square) &&
+          mult_vinograd_simd(odd_a, odd_b, level) == odd_expected;
+  }
+  std::cout << (ok8 ? "TEST 8 PASSED\n" : "TEST 8 FAILED\n");
+
+  int rejected = 0;
+  try {
+    Matrix ragged = NestedMatrix{{1, 2}, {3, 4, 5}};
+  } catch (const std::invalid_argument &) {
+    ++rejected;
+  }
+  try {
+    Matrix ragged = {{1, 2, 3}, {4}};
+  } catch (const std::invalid_argument &) {
+    ++rejected;
+  }
+  std::cout << (rejected == 2 ? "TEST 9 PASSED\n" : "TEST 9 FAILED\n");
+
   return 0;
 }
@@ -0,0 +1,253 @@
+#include "annealing_solver.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <utility>
+
+#include "parallel.h"
+
+namespace lr4 {
+namespace {
+
+// Metropolis criterion on a move that replaces the `removed` edges with the
+// `added` ones. Moves that change the number of missing edges are decided by
+// that number alone.
+bool Accept(const TourCost& added, const TourCost& removed, double temperature, std::mt19937& rng) {
+  if (added.missing != removed.missing) {
+    return added.missing < removed.missing;
+  }
+  double delta = added.finite - removed.finite;
+  if (delta <= 0.0) {
+    return true;
+  }
+  if (temperature <= 0.0) {
+    return false;
+  }
+  std::uniform_real_distribution<double> unit(0.0, 1.0);
+  return unit(rng) < std::exp(-delta / temperature);
+}
+
+void ApplyDelta(const TourCost& added, const TourCost& removed, TourCost* cost) {
+  cost->missing += added.missing - removed.missing;
+  cost->finite += added.finite - removed.finite;
+}
+
+}  // namespace
+
+AnnealingSolver::AnnealingSolver(const Graph& graph) : graph_(graph) {}
+
+TourResult AnnealingSolver::Run(const AnnealingParameters& params, size_t thread_count,
+                                SearchControl* control) const {
+  TourResult result;
+  const size_t n = graph_.VertexCount();
+  if (thread_count == 0 || n == 0) {
+    return result;
+  }
+  auto start = std::chrono::steady_clock::now();
+  const bool symmetric = graph_.IsSymmetric();
+  std::vector<int> initial = GreedyTour(graph_);
+  initial.pop_back();
+  const TourCost initial_cost = CycleCost(graph_, initial);
+  const size_t finite_edges = n - static_cast<size_t>(initial_cost.missing);
+  double mean_edge = finite_edges > 0 ? initial_cost.finite / static_cast<double>(finite_edges) : 1.0;
+  if (mean_edge <= 0.0) {
+    mean_edge = 1.0;
+  }
+
+  // Geometric temperature ladder, replica 0 being the hottest.
+  const size_t replicas_count = thread_count;
+  std::vector<double> temperatures(replicas_count);
+  for (size_t r = 0; r < replicas_count; ++r) {
+    double position = replicas_count > 1
+                          ? static_cast<double>(r) / static_cast<double>(replicas_count - 1)
+                          : 0.0;
+    temperatures[r] = mean_edge * params.hot_temperature *
+                      std::pow(params.cold_temperature / params.hot_temperature, position);
+  }
+  std::vector<Replica> replicas(replicas_count);
+  for (size_t r = 0; r < replicas_count; ++r) {
+    replicas[r].cycle = initial;
+    replicas[r].cost = initial_cost;
+    replicas[r].best = initial;
+    replicas[r].best_cost = initial_cost;
+    replicas[r].rng.seed(params.seed + static_cast<unsigned int>(r * 9973));
+  }
+
+  const size_t interval = std::max<size_t>(1, params.exchange_interval);
+  const size_t rounds = std::max<size_t>(1, (params.steps + interval - 1) / interval);
+  const size_t window = std::max<size_t>(1, params.window);
+  std::mt19937 exchange_rng(params.seed);
+  std::uniform_real_distribution<double> unit(0.0, 1.0);
+  std::vector<TracePoint> trace;
+  auto record = [&]() {
+    TourCost best_cost = replicas.front().best_cost;
+    for (const Replica& replica : replicas) {
+      if (replica.best_cost < best_cost) {
+        best_cost = replica.best_cost;
+      }
+    }
+    RecordTrace(start, best_cost.missing == 0 ? best_cost.finite : Graph::kInfinity, &trace);
+  };
+  record();
+  for (size_t round = 0; round < rounds; ++round) {
+    if (control != nullptr && control->Expired()) {
+      break;
+    }
+    double progress = rounds > 1 ? static_cast<double>(round) / static_cast<double>(rounds - 1) : 1.0;
+    if (control != nullptr) {
+      progress = std::max(progress, control->Progress());
+    }
+    double scale = std::pow(params.final_scale, progress);
+    size_t steps = std::min(interval, params.steps - round * interval);
+    ParallelFor(replicas_count, thread_count, [&](size_t r, size_t) {
+      Anneal(&replicas[r], temperatures[r] * scale, steps, window, symmetric);
+    });
+    // Replica exchange between neighbours, alternating even and odd pairs.
+    for (size_t r = round % 2; r + 1 < replicas_count; r += 2) {
+      Replica& hot = replicas[r];
+      Replica& cold = replicas[r + 1];
+      bool swap = false;
+      if (hot.cost.missing != cold.cost.missing) {
+        swap = hot.cost.missing < cold.cost.missing;
+      } else {
+        double beta_hot = 1.0 / (temperatures[r] * scale);
+        double beta_cold = 1.0 / (temperatures[r + 1] * scale);
+        double exponent = (beta_cold - beta_hot) * (cold.cost.finite - hot.cost.finite);
+        swap = exponent >= 0.0 || unit(exchange_rng) < std::exp(exponent);
+      }
+      if (swap) {
+        std::swap(hot.cycle, cold.cycle);
+        std::swap(hot.cost, cold.cost);
+      }
+    }
+    record();
+    if (control != nullptr) {
+      ExchangeIncumbent(control, &replicas);
+    }
+  }
+
+  const Replica* best = &replicas.front();
+  for (const Replica& replica : replicas) {
+    if (replica.best_cost < best->best_cost) {
+      best = &replica;
+    }
+  }
+  std::vector<int> tour = best->best;
+  tour.push_back(tour.front());
+  result = SingleTourResult(graph_, tour);
+  result.trace = std::move(trace);
+  auto end = std::chrono::steady_clock::now();
+  result.elapsed_ms = std::chrono::duration<double, std::milli>(end - start).count();
+  return result;
+}
+
+void AnnealingSolver::ExchangeIncumbent(SearchControl* control,
+                                        std::vector<Replica>* replicas) const {
+  const Replica* best = &replicas->front();
+  for (const Replica& replica : *replicas) {
+    if (replica.best_cost < best->best_cost) {
+      best = &replica;
+    }
+  }
+  double best_length = best->best_cost.missing == 0 ? best->best_cost.finite : Graph::kInfinity;
+  if (best_length < control->BestLength()) {
+    std::vector<int> tour = best->best;
+    tour.push_back(tour.front());
+    control->Offer(tour, best_length);
+  }
+  std::vector<int> incumbent;
+  if (control->TakeIfBetter(best_length, &incumbent)) {
+    Replica& coldest = replicas->back();
+    coldest.cycle.assign(incumbent.begin(), incumbent.end() - 1);
+    coldest.cost = CycleCost(graph_, coldest.cycle);
+  }
+}
+
+void AnnealingSolver::Anneal(Replica* replica, double temperature, size_t steps, size_t window,
+                             bool symmetric) const {
+  std::vector<int>& t = replica->cycle;
+  const size_t n = t.size();
+  auto w = [this](int from, int to) {
+    return graph_.Weight(static_cast<size_t>(from), static_cast<size_t>(to));
+  };
+  std::mt19937& rng = replica->rng;
+  std::uniform_int_distribution<size_t> offset_dist(1, window);
+  std::bernoulli_distribution coin(0.5);
+  for (size_t step = 0; step < steps && n >= 5; ++step) {
+    if (symmetric && coin(rng)) {
+      // 2-opt: reverse t[i..j], replacing (a, b) and (c, d) by (a, c) and (b, d).
+      size_t i = std::uniform_int_distribution<size_t>(0, n - 2)(rng);
+      size_t j = std::min(n - 1, i + offset_dist(rng));
+      if (i == 0 && j == n - 1) {
+        continue;
+      }
+      const int a = t[(i + n - 1) % n];
+      const int b = t[i];
+      const int c = t[j];
+      const int d = t[(j + 1) % n];
+      TourCost removed;
+      removed.Add(w(a, b));
+      removed.Add(w(c, d));
+      TourCost added;
+      added.Add(w(a, c));
+      added.Add(w(b, d));
+      if (Accept(added, removed, temperature, rng)) {
+        std::reverse(t.begin() + static_cast<long>(i), t.begin() + static_cast<long>(j + 1));
+        ApplyDelta(added, removed, &replica->cost);
+      }
+      continue;
+    }
+    // Or-opt: move t[i..i+length) between t[p] and t[p + 1], keeping its orientation.
+    size_t length = std::uniform_int_distribution<size_t>(1, std::min<size_t>(3, n - 3))(rng);
+    size_t i = std::uniform_int_distribution<size_t>(0, n - length)(rng);
+    size_t offset = offset_dist(rng);
+    const size_t prev_pos = (i + n - 1) % n;
+    size_t p = 0;
+    if (coin(rng)) {
+      p = i + length - 1 + offset;
+      if (p >= n || p == prev_pos) {
+        continue;
+      }
+    } else {
+      if (i < offset + 1) {
+        continue;
+      }
+      p = i - 1 - offset;
+    }
+    const int prev = t[prev_pos];
+    const int first = t[i];
+    const int last = t[i + length - 1];
+    const int next = t[(i + length) % n];
+    const int a = t[p];
+    const int b = t[(p + 1) % n];
+    TourCost removed;
+    removed.Add(w(prev, first));
+    removed.Add(w(last, next));
+    removed.Add(w(a, b));
+    TourCost added;
+    added.Add(w(prev, next));
+    added.Add(w(a, first));
+    added.Add(w(last, b));
+    if (!Accept(added, removed, temperature, rng)) {
+      continue;
+    }
+    if (p > i) {
+      std::rotate(t.begin() + static_cast<long>(i), t.begin() + static_cast<long>(i + length),
+                  t.begin() + static_cast<long>(p + 1));
+    } else {
+      std::rotate(t.begin() + static_cast<long>(p + 1), t.begin() + static_cast<long>(i),
+                  t.begin() + static_cast<long>(i + length));
+    }
+    ApplyDelta(added, removed, &replica->cost);
+  }
+  // Deltas accumulate rounding error; resynchronise once per round, which is
+  // also the granularity at which the replica's best tour is recorded.
+  replica->cost = CycleCost(graph_, t);
+  if (replica->cost < replica->best_cost) {
+    replica->best = t;
+    replica->best_cost = replica->cost;
+  }
+}
+
+}  // namespace lr4
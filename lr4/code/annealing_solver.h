@@ -0,0 +1,59 @@
+#ifndef LR4_ANNEALING_SOLVER_H
+#define LR4_ANNEALING_SOLVER_H
+
+#include <cstddef>
+#include <random>
+#include <vector>
+
+#include "ant_colony_solver.h"
+#include "graph.h"
+#include "local_search.h"
+#include "search_control.h"
+
+namespace lr4 {
+
+struct AnnealingParameters {
+  size_t steps = 200000;             // moves attempted by every replica
+  size_t exchange_interval = 2000;   // moves between replica exchanges
+  size_t window = 64;                // maximal distance between the ends of a move
+  double hot_temperature = 0.5;      // hottest replica, relative to the mean edge of the start tour
+  double cold_temperature = 0.005;   // coldest replica, same scale
+  double final_scale = 0.05;         // factor applied to every temperature by the last round
+  unsigned int seed = 42;            // random seed
+};
+
+// Simulated annealing over tours with parallel tempering: every thread owns a
+// replica at its own temperature, and neighbouring replicas swap tours
+// between rounds. Moves are or-opt (any graph) and 2-opt (symmetric graphs
+// only); both are evaluated in O(1) from Graph::Weight. Memory is O(n) per
+// replica, no pheromone matrix is kept.
+class AnnealingSolver {
+ public:
+  explicit AnnealingSolver(const Graph& graph);
+
+  // With a `control`, cooling follows the time limit instead of the step
+  // budget, replica bests are published and a shorter incumbent replaces the
+  // coldest replica.
+  TourResult Run(const AnnealingParameters& params, size_t thread_count,
+                 SearchControl* control = nullptr) const;
+
+ private:
+  struct Replica {
+    std::vector<int> cycle;   // open cycle, without the repeated start vertex
+    TourCost cost;
+    std::vector<int> best;
+    TourCost best_cost;
+    std::mt19937 rng;
+  };
+
+  void Anneal(Replica* replica, double temperature, size_t steps, size_t window,
+              bool symmetric) const;
+
+  void ExchangeIncumbent(SearchControl* control, std::vector<Replica>* replicas) const;
+
+  const Graph& graph_;
+};
+
+}  // namespace lr4
+
+#endif  // LR4_ANNEALING_SOLVER_H
@@ -5,6 +5,10 @@
 #include <cmath>
 #include <thread>
 
+#include "local_search.h"
+#include "solver_metrics.h"
+#include "trace_recorder.h"
+
 namespace lr4 {
 namespace {
 
@@ -15,55 +19,220 @@ double Heuristic(double weight) {
   return 1.0 / weight;
 }
 
+// Upper bound on the up-front reservation for per-iteration stats: time-limited
+// runs pass an unbounded iteration count, so the buffer grows past this.
+constexpr size_t kReservedIterationStats = 4096;
+
 bool AreEqual(double a, double b) {
   constexpr double kEps = 1e-9;
   return std::fabs(a - b) <= kEps;
 }
 
+// Tour lengths of the ants of one iteration; an infinite length is an ant
+// that did not produce a tour.
+struct AntTally {
+  size_t completed = 0;
+  size_t dead_ends = 0;
+  double sum = 0.0;
+  double best = Graph::kInfinity;
+  double worst = 0.0;
+
+  void Add(double length) {
+    if (!std::isfinite(length)) {
+      ++dead_ends;
+      return;
+    }
+    ++completed;
+    sum += length;
+    best = std::min(best, length);
+    worst = std::max(worst, length);
+  }
+
+  void Merge(const AntTally& other) {
+    completed += other.completed;
+    dead_ends += other.dead_ends;
+    sum += other.sum;
+    best = std::min(best, other.best);
+    worst = std::max(worst, other.worst);
+  }
+};
+
+double BranchingFactor(const Graph& graph, const std::vector<std::vector<double>>& pheromone) {
+  constexpr double kLambda = 0.05;
+  const size_t n = graph.VertexCount();
+  if (n < 2) {
+    return 0.0;
+  }
+  double total = 0.0;
+  for (size_t i = 0; i < n; ++i) {
+    double low = Graph::kInfinity;
+    double high = 0.0;
+    for (size_t j = 0; j < n; ++j) {
+      if (j != i && std::isfinite(graph.Weight(i, j))) {
+        low = std::min(low, pheromone[i][j]);
+        high = std::max(high, pheromone[i][j]);
+      }
+    }
+    if (!std::isfinite(low)) {
+      continue;
+    }
+    const double threshold = low + kLambda * (high - low);
+    size_t above = 0;
+    for (size_t j = 0; j < n; ++j) {
+      if (j != i && std::isfinite(graph.Weight(i, j)) && pheromone[i][j] >= threshold) {
+        ++above;
+      }
+    }
+    total += static_cast<double>(above);
+  }
+  return total / static_cast<double>(n);
+}
+
+IterationStats MakeIterationStats(size_t iteration, const AntTally& tally, double best_so_far,
+                                  const Graph& graph,
+                                  const std::vector<std::vector<double>>& pheromone) {
+  IterationStats stats;
+  stats.iteration = iteration;
+  if (tally.completed > 0) {
+    stats.iteration_best = tally.best;
+    stats.mean = tally.sum / static_cast<double>(tally.completed);
+    stats.worst = tally.worst;
+  }
+  stats.best_so_far = best_so_far;
+  stats.branching = BranchingFactor(graph, pheromone);
+  stats.dead_ends = tally.dead_ends;
+  return stats;
+}
+
 }  // namespace
 
+TourResult SingleTourResult(const Graph& graph, const std::vector<int>& tour) {
+  TourResult result;
+  double length = TourLength(graph, tour);
+  if (!std::isfinite(length)) {
+    return result;
+  }
+  std::vector<int> canonical = graph.CanonicalizeTour(tour);
+  std::string serialized;
+  for (size_t i = 0; i < canonical.size(); ++i) {
+    if (i != 0) {
+      serialized += "->";
+    }
+    serialized += graph.Label(static_cast<size_t>(canonical[i]));
+  }
+  result.best_length = length;
+  result.best_paths.push_back(std::move(canonical));
+  result.best_paths_labels.push_back(std::move(serialized));
+  return result;
+}
+
+void RecordTrace(std::chrono::steady_clock::time_point start, double length,
+                 std::vector<TracePoint>* trace) {
+  if (!std::isfinite(length) || (!trace->empty() && !(length < trace->back().best_length))) {
+    return;
+  }
+  auto now = std::chrono::steady_clock::now();
+  double elapsed_ms = std::chrono::duration<double, std::milli>(now - start).count();
+  trace->push_back(TracePoint{elapsed_ms, length});
+}
+
 AntColonySolver::AntColonySolver(const Graph& graph) : graph_(graph) {}
 
-TourResult AntColonySolver::RunSequential(const AntColonyParameters& params) const {
+TourResult AntColonySolver::RunSequential(const AntColonyParameters& params,
+                                          SearchControl* control) const {
   TourResult result;
   auto pheromone = InitialPheromone();
   std::mt19937 rng(params.seed);
+  PhaseTicks ticks{};
+  TraceTracks tracks("aco", 0);
+  TraceRecorder* trace = tracks.recorder();
+  SolverMetrics* metrics = SolverMetrics::Active();
+  if (params.iteration_stats) {
+    result.iterations.reserve(std::min(params.iterations, kReservedIterationStats));
+  }
   auto start = std::chrono::steady_clock::now();
+  const uint64_t start_ticks = ReadTimestamp();
   for (size_t iteration = 0; iteration < params.iterations; ++iteration) {
+    if (control != nullptr && control->Expired()) {
+      break;
+    }
+    TraceSpan iteration_span(trace, tracks.Main(), "iteration");
     std::vector<std::vector<double>> delta(graph_.VertexCount(),
                                            std::vector<double>(graph_.VertexCount(), 0.0));
+    TraceSpan ants_span(trace, tracks.Main(), "ants");
+    AntTally tally;
+    uint64_t mark = ReadTimestamp();
     for (size_t ant = 0; ant < params.ants; ++ant) {
       AntPath path = ConstructSolution(rng, params, pheromone);
+      Lap(Phase::kConstruction, &mark, &ticks);
+      tally.Add(path.length);
       if (path.path.empty()) {
         continue;
       }
       DepositPheromone(path, params.q, &delta);
+      Lap(Phase::kDeposit, &mark, &ticks);
       UpdateBest(path, &result.best_paths, &result.best_length, &result.best_paths_labels);
+      Lap(Phase::kBestUpdate, &mark, &ticks);
     }
-    for (size_t i = 0; i < graph_.VertexCount(); ++i) {
-      for (size_t j = 0; j < graph_.VertexCount(); ++j) {
-        pheromone[i][j] = (1.0 - params.evaporation) * pheromone[i][j] + delta[i][j];
-        if (pheromone[i][j] < 1e-12) {
-          pheromone[i][j] = 1e-12;
-        }
-      }
+    ants_span.End();
+    RecordTrace(start, result.best_length, &result.trace);
+    TraceSpan evaporation_span(trace, tracks.Main(), "evaporation");
+    mark = ReadTimestamp();
+    Evaporate(params.evaporation, delta, &pheromone);
+    Lap(Phase::kEvaporation, &mark, &ticks);
+    evaporation_span.End();
+    if (params.iteration_stats) {
+      result.iterations.push_back(
+          MakeIterationStats(iteration, tally, result.best_length, graph_, pheromone));
+    }
+    if (metrics != nullptr) {
+      metrics->AddIteration(SolveVariant::kSequential, params.ants, tally.dead_ends);
+    }
+    if (control != nullptr) {
+      ExchangeIncumbent(result, params.q, control, &pheromone);
     }
   }
+  const uint64_t end_ticks = ReadTimestamp();
   auto end = std::chrono::steady_clock::now();
   result.elapsed_ms = std::chrono::duration<double, std::milli>(end - start).count();
+  result.phase_ms = TicksToMilliseconds(ticks, end_ticks - start_ticks, result.elapsed_ms);
+  if (metrics != nullptr) {
+    metrics->AddSolve(SolveVariant::kSequential, result.elapsed_ms, result.elapsed_ms,
+                      result.elapsed_ms);
+  }
   return result;
 }
 
 TourResult AntColonySolver::RunParallel(const AntColonyParameters& params,
-                                        size_t thread_count) const {
+                                        size_t thread_count,
+                                        SearchControl* control,
+                                        WorkerObserver* observer) const {
   TourResult result;
   if (thread_count == 0) {
     return result;
   }
   auto pheromone = InitialPheromone();
+  // Workers only touch their own tick counters; the barrier wait of a worker
+  // runs from the end of its share to the moment all of them are joined.
+  PhaseTicks ticks{};
+  std::vector<PhaseTicks> thread_ticks(thread_count, PhaseTicks{});
+  std::vector<uint64_t> finished(thread_count);
+  TraceTracks tracks("aco", thread_count);
+  TraceRecorder* trace = tracks.recorder();
+  std::vector<AntTally> tallies(thread_count);
+  std::vector<LockCounter> lock_counters(thread_count);
+  SolverMetrics* metrics = SolverMetrics::Active();
+  if (params.iteration_stats) {
+    result.iterations.reserve(std::min(params.iterations, kReservedIterationStats));
+  }
   auto start = std::chrono::steady_clock::now();
+  const uint64_t start_ticks = ReadTimestamp();
   std::mutex best_mutex;
   for (size_t iteration = 0; iteration < params.iterations; ++iteration) {
+    if (control != nullptr && control->Expired()) {
+      break;
+    }
+    TraceSpan iteration_span(trace, tracks.Main(), "iteration");
     std::vector<std::vector<double>> delta(graph_.VertexCount(),
                                            std::vector<double>(graph_.VertexCount(), 0.0));
     std::vector<std::vector<std::vector<double>>> local_deltas(thread_count,
@@ -72,21 +241,32 @@ TourResult AntColonySolver::RunParallel(const AntColonyParameters& params,
     workers.reserve(thread_count);
     size_t base = params.ants / thread_count;
     size_t remainder = params.ants % thread_count;
+    std::fill(finished.begin(), finished.end(), 0);
+    std::fill(tallies.begin(), tallies.end(), AntTally());
     for (size_t t = 0; t < thread_count; ++t) {
       size_t assigned = base + (t < remainder ? 1 : 0);
       workers.emplace_back([&, t, assigned]() {
         if (assigned == 0) {
           return;
         }
+        if (observer != nullptr) {
+          observer->OnWorkerStart(t);
+        }
         std::mt19937 rng(params.seed + static_cast<unsigned int>(t * 9973 + iteration * 7919));
         double thread_best_length = Graph::kInfinity;
         std::vector<AntPath> thread_best_paths;
+        PhaseTicks& own_ticks = thread_ticks[t];
+        TraceSpan batch_span(trace, tracks.Worker(t), "ants");
+        uint64_t mark = ReadTimestamp();
         for (size_t ant = 0; ant < assigned; ++ant) {
           AntPath path = ConstructSolution(rng, params, pheromone);
+          Lap(Phase::kConstruction, &mark, &own_ticks);
+          tallies[t].Add(path.length);
           if (path.path.empty()) {
             continue;
           }
           DepositPheromone(path, params.q, &local_deltas[t]);
+          Lap(Phase::kDeposit, &mark, &own_ticks);
           if (path.length + 1e-9 < thread_best_length) {
             thread_best_length = path.length;
             thread_best_paths.clear();
@@ -94,18 +274,40 @@ TourResult AntColonySolver::RunParallel(const AntColonyParameters& params,
           } else if (AreEqual(path.length, thread_best_length)) {
             thread_best_paths.push_back(path);
           }
+          Lap(Phase::kBestUpdate, &mark, &own_ticks);
         }
+        batch_span.End();
         if (!thread_best_paths.empty()) {
-          std::lock_guard<std::mutex> lock(best_mutex);
+          TraceSpan wait_span(trace, tracks.Worker(t), "lock wait");
+          std::unique_lock<std::mutex> lock = LockCounted(best_mutex, &lock_counters[t]);
+          wait_span.End();
+          TraceSpan update_span(trace, tracks.Worker(t), "best update");
           for (const AntPath& best_local : thread_best_paths) {
             UpdateBest(best_local, &result.best_paths, &result.best_length, &result.best_paths_labels);
           }
         }
+        Lap(Phase::kBestUpdate, &mark, &own_ticks);
+        finished[t] = mark;
+        if (observer != nullptr) {
+          observer->OnWorkerStop(t);
+        }
       });
     }
+    TraceSpan join_span(trace, tracks.Main(), "join");
     for (auto& worker : workers) {
       worker.join();
     }
+    join_span.End();
+    ++result.sync.barriers;
+    uint64_t mark = ReadTimestamp();
+    for (size_t t = 0; t < thread_count; ++t) {
+      if (finished[t] != 0) {
+        thread_ticks[t][static_cast<size_t>(Phase::kBarrierWait)] += mark - finished[t];
+      }
+    }
+    RecordTrace(start, result.best_length, &result.trace);
+    TraceSpan reduction_span(trace, tracks.Main(), "reduction");
+    mark = ReadTimestamp();
     for (size_t t = 0; t < thread_count; ++t) {
       for (size_t i = 0; i < graph_.VertexCount(); ++i) {
         for (size_t j = 0; j < graph_.VertexCount(); ++j) {
@@ -113,17 +315,52 @@ TourResult AntColonySolver::RunParallel(const AntColonyParameters& params,
         }
       }
     }
-    for (size_t i = 0; i < graph_.VertexCount(); ++i) {
-      for (size_t j = 0; j < graph_.VertexCount(); ++j) {
-        pheromone[i][j] = (1.0 - params.evaporation) * pheromone[i][j] + delta[i][j];
-        if (pheromone[i][j] < 1e-12) {
-          pheromone[i][j] = 1e-12;
-        }
-      }
+    Lap(Phase::kReduction, &mark, &ticks);
+    reduction_span.End();
+    TraceSpan evaporation_span(trace, tracks.Main(), "evaporation");
+    Evaporate(params.evaporation, delta, &pheromone);
+    Lap(Phase::kEvaporation, &mark, &ticks);
+    evaporation_span.End();
+    AntTally tally;
+    for (const AntTally& thread_tally : tallies) {
+      tally.Merge(thread_tally);
+    }
+    if (params.iteration_stats) {
+      result.iterations.push_back(
+          MakeIterationStats(iteration, tally, result.best_length, graph_, pheromone));
+    }
+    if (metrics != nullptr) {
+      metrics->AddIteration(SolveVariant::kParallel, params.ants, tally.dead_ends);
+    }
+    if (control != nullptr) {
+      ExchangeIncumbent(result, params.q, control, &pheromone);
     }
   }
+  const uint64_t end_ticks = ReadTimestamp();
   auto end = std::chrono::steady_clock::now();
   result.elapsed_ms = std::chrono::duration<double, std::milli>(end - start).count();
+  result.phase_ms = TicksToMilliseconds(ticks, end_ticks - start_ticks, result.elapsed_ms);
+  for (const PhaseTicks& own_ticks : thread_ticks) {
+    PhaseTimes times = TicksToMilliseconds(own_ticks, end_ticks - start_ticks, result.elapsed_ms);
+    for (size_t phase = 0; phase < kPhaseCount; ++phase) {
+      result.phase_ms[phase] += times[phase];
+    }
+    result.thread_phase_ms.push_back(times);
+    result.sync.barrier_idle_ms.push_back(times[static_cast<size_t>(Phase::kBarrierWait)]);
+  }
+  for (const LockCounter& counter : lock_counters) {
+    result.sync.Add(counter);
+  }
+  if (metrics != nullptr) {
+    double busy_ms = 0.0;
+    for (const PhaseTimes& times : result.thread_phase_ms) {
+      busy_ms += times[static_cast<size_t>(Phase::kConstruction)] +
+                 times[static_cast<size_t>(Phase::kDeposit)] +
+                 times[static_cast<size_t>(Phase::kBestUpdate)];
+    }
+    metrics->AddSolve(SolveVariant::kParallel, result.elapsed_ms, busy_ms,
+                      result.elapsed_ms * static_cast<double>(thread_count));
+  }
   return result;
 }
 
@@ -202,6 +439,20 @@ void AntColonySolver::DepositPheromone(const AntPath& path,
   }
 }
 
+void AntColonySolver::Evaporate(double evaporation,
+                                const std::vector<std::vector<double>>& delta,
+                                std::vector<std::vector<double>>* pheromone) {
+  for (size_t i = 0; i < pheromone->size(); ++i) {
+    std::vector<double>& row = (*pheromone)[i];
+    for (size_t j = 0; j < row.size(); ++j) {
+      row[j] = (1.0 - evaporation) * row[j] + delta[i][j];
+      if (row[j] < 1e-12) {
+        row[j] = 1e-12;
+      }
+    }
+  }
+}
+
 void AntColonySolver::UpdateBest(const AntPath& candidate,
                                  std::vector<std::vector<int>>* best_paths,
                                  double* best_length,
@@ -237,6 +488,22 @@ std::vector<std::vector<double>> AntColonySolver::InitialPheromone() const {
   return std::vector<std::vector<double>>(n, std::vector<double>(n, initial_value));
 }
 
+void AntColonySolver::ExchangeIncumbent(const TourResult& result,
+                                        double q,
+                                        SearchControl* control,
+                                        std::vector<std::vector<double>>* pheromone) const {
+  if (!result.best_paths.empty()) {
+    control->Offer(result.best_paths.front(), result.best_length);
+  }
+  // A shorter tour found elsewhere is reinforced like an elitist ant, which
+  // pulls this colony towards it instead of discarding its own trails.
+  AntPath incumbent;
+  if (control->TakeIfBetter(result.best_length, &incumbent.path)) {
+    incumbent.length = ComputePathLength(incumbent.path);
+    DepositPheromone(incumbent, q, pheromone);
+  }
+}
+
 double AntColonySolver::ComputePathLength(const std::vector<int>& path) const {
   if (path.size() < 2) {
     return Graph::kInfinity;
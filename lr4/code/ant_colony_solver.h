@@ -1,12 +1,16 @@
 #ifndef LR4_ANT_COLONY_SOLVER_H
 #define LR4_ANT_COLONY_SOLVER_H
 
+#include <chrono>
 #include <cstddef>
 #include <mutex>
 #include <random>
 #include <vector>
 
 #include "graph.h"
+#include "parallel.h"
+#include "phase_profile.h"
+#include "search_control.h"
 
 namespace lr4 {
 
@@ -18,6 +22,27 @@ struct AntColonyParameters {
   double evaporation = 0.5;   // pheromone evaporation rate
   double q = 100.0;           // pheromone deposit factor
   unsigned int seed = 42;     // random seed
+  bool iteration_stats = false;  // fill TourResult::iterations; adds an O(n^2) pass per iteration
+};
+
+// Convergence of one colony iteration. Lengths are over the ants that closed
+// a tour and are infinite if none did.
+struct IterationStats {
+  size_t iteration = 0;
+  double iteration_best = Graph::kInfinity;
+  double mean = Graph::kInfinity;
+  double worst = Graph::kInfinity;
+  double best_so_far = Graph::kInfinity;
+  // Mean lambda-branching factor (lambda = 0.05) of the pheromone after the
+  // update: edges per vertex above min + 0.05 (max - min) of its row. It
+  // falls towards 1 as the colony converges on a single tour.
+  double branching = 0.0;
+  size_t dead_ends = 0;       // ants that got stuck or could not close the tour
+};
+
+struct TracePoint {
+  double elapsed_ms = 0.0;
+  double best_length = Graph::kInfinity;
 };
 
 struct TourResult {
@@ -25,16 +50,56 @@ struct TourResult {
   std::vector<std::vector<int>> best_paths;
   std::vector<std::string> best_paths_labels;
   double elapsed_ms = 0.0;
+  // Best length after every improvement, with the time since the start of
+  // the run; lengths are strictly decreasing.
+  std::vector<TracePoint> trace;
+  // One entry per iteration when AntColonyParameters::iteration_stats is set.
+  std::vector<IterationStats> iterations;
+  // Time spent in each phase, in milliseconds. Phases run by worker threads
+  // are summed over the workers, so in parallel runs the total can exceed
+  // elapsed_ms; thread_phase_ms holds them per worker. Engines fill only the
+  // phases they have.
+  PhaseTimes phase_ms{};
+  std::vector<PhaseTimes> thread_phase_ms;
+  // Lock and barrier overhead of engines that run worker threads.
+  SyncStats sync;
+};
+
+// Appends (now - start, length) to `trace` if `length` is finite and shorter
+// than its last point.
+void RecordTrace(std::chrono::steady_clock::time_point start, double length,
+                 std::vector<TracePoint>* trace);
+
+// Result holding a single closed tour (front == back), as produced by the
+// engines that keep one incumbent; best_paths stays empty if it is infeasible.
+TourResult SingleTourResult(const Graph& graph, const std::vector<int>& tour);
+
+// Hooks around the work of each RunParallel worker thread, for
+// instrumentation that has to run on the worker itself, such as per-thread
+// hardware counters. Both calls are made on the worker, once per iteration.
+class WorkerObserver {
+ public:
+  virtual ~WorkerObserver() = default;
+  virtual void OnWorkerStart(size_t worker) = 0;
+  virtual void OnWorkerStop(size_t worker) = 0;
 };
 
 class AntColonySolver {
  public:
   explicit AntColonySolver(const Graph& graph);
 
-  TourResult RunSequential(const AntColonyParameters& params) const;
-  TourResult RunParallel(const AntColonyParameters& params, size_t thread_count) const;
+  // With a `control`, the run also stops at its deadline, publishes every
+  // improvement and reinforces the shared incumbent when it is shorter.
+  TourResult RunSequential(const AntColonyParameters& params,
+                           SearchControl* control = nullptr) const;
+  TourResult RunParallel(const AntColonyParameters& params, size_t thread_count,
+                         SearchControl* control = nullptr,
+                         WorkerObserver* observer = nullptr) const;
 
  private:
+  // Exposes the kernels below to the micro-benchmarks.
+  friend class AntColonyMicrobench;
+
   struct AntPath {
     std::vector<int> path;
     double length = Graph::kInfinity;
@@ -48,6 +113,11 @@ class AntColonySolver {
                                double q,
                                std::vector<std::vector<double>>* deltas);
 
+  // pheromone = (1 - evaporation) * pheromone + delta, floored at 1e-12.
+  static void Evaporate(double evaporation,
+                        const std::vector<std::vector<double>>& delta,
+                        std::vector<std::vector<double>>* pheromone);
+
   void UpdateBest(const AntPath& candidate,
                   std::vector<std::vector<int>>* best_paths,
                   double* best_length,
@@ -55,6 +125,11 @@ class AntColonySolver {
 
   std::vector<std::vector<double>> InitialPheromone() const;
 
+  void ExchangeIncumbent(const TourResult& result,
+                         double q,
+                         SearchControl* control,
+                         std::vector<std::vector<double>>* pheromone) const;
+
   double ComputePathLength(const std::vector<int>& path) const;
 
   std::vector<std::string> PathToLabels(const std::vector<int>& path) const;
@@ -1,32 +1,79 @@
+#include <sys/resource.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+
 #include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cmath>
 #include <cstddef>
+#include <cstdio>
 #include <cstdlib>
+#include <ctime>
+#include <filesystem>
 #include <optional>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include <map>
-#include <random>
+#include <memory>
+#include <set>
 #include <stdexcept>
 #include <sstream>
 #include <string>
 #include <string_view>
 #include <thread>
-#include <unordered_map>
-#include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include "annealing_solver.h"
 #include "ant_colony_solver.h"
 #include "graph.h"
+#include "instance_generator.h"
+#include "perf_counters.h"
+#include "statistics.h"
+#include "trace_recorder.h"
+
+#ifndef LR4_BUILD_FLAGS
+#define LR4_BUILD_FLAGS "unknown"
+#endif
+
+// Every heap allocation of the process goes through these counters, so the
+// allocations of a run include the threads the solver spawns.
+namespace {
+
+std::atomic<size_t> g_allocations{0};
+std::atomic<size_t> g_allocated_bytes{0};
+
+void* CountedAllocate(size_t size) {
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  g_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+  if (void* pointer = std::malloc(size == 0 ? 1 : size)) {
+    return pointer;
+  }
+  throw std::bad_alloc();
+}
+
+}  // namespace
+
+void* operator new(size_t size) { return CountedAllocate(size); }
+void* operator new[](size_t size) { return CountedAllocate(size); }
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, size_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { std::free(pointer); }
 
 namespace {
 
 struct Options {
   std::vector<size_t> sizes = {3000, 3500, 4000, 4500, 5000, 5500, 6000, 6500, 7000};
   size_t runs = 100;
+  size_t warmup = 1;                     // untimed runs before every measured series
   std::string output = "benchmark_results.csv";
+  std::string json_output;               // empty: next to `output` with a .json extension
+  std::vector<double> targets = {1.0, 1.01, 1.02, 1.05, 1.1};   // relative to the best length
+  size_t deadlines = 20;                 // points of the quality-at-deadline curve
   size_t ants = 128;
   size_t iterations = 150;
   double alpha = 1.0;
@@ -35,8 +82,26 @@ struct Options {
   double q = 100.0;
   unsigned int seed = 42;
   size_t max_out_degree = 15;
+  bool annealing = false;
+  size_t annealing_steps = 200000;
+  std::string instance = "sparse";
+  double asymmetry = 0.0;
+  std::string cache_dir;                 // binary instance cache; empty: no cache
+  bool counters = true;                  // hardware counters via perf_event_open
+  // Per-worker counters of RunParallel. Workers are new threads every
+  // iteration, so their counters are opened and closed inside the timed
+  // region; off by default to keep parallel timings comparable.
+  bool worker_counters = false;
+  std::string scaling;                   // "strong" or "weak": sweep 1..cores instead
+  std::string baseline;                  // results CSV of an earlier run to compare against
+  double regression_threshold = 0.05;    // tolerated relative slowdown of the median
+  std::string trace_path;                // Chrome trace-event file of all runs
 };
 
+// Exit status when a configuration is slower than the baseline beyond the
+// threshold; errors keep EXIT_FAILURE.
+constexpr int kExitRegression = 2;
+
 std::vector<std::string> Split(std::string_view text, char delimiter) {
   std::vector<std::string> result;
   std::string current;
@@ -95,9 +160,27 @@ Options ParseArgs(int argc, char** argv) {
       options.runs = 1;
     }
   }
+  if (auto value = get("--warmup")) {
+    options.warmup = static_cast<size_t>(std::stoull(*value));
+  }
   if (auto value = get("--output")) {
     options.output = *value;
   }
+  if (auto value = get("--json")) {
+    options.json_output = *value;
+  }
+  if (auto value = get("--targets")) {
+    std::vector<double> parsed;
+    for (const std::string& token : Split(*value, ',')) {
+      parsed.push_back(std::stod(token));
+    }
+    if (!parsed.empty()) {
+      options.targets = std::move(parsed);
+    }
+  }
+  if (auto value = get("--deadlines")) {
+    options.deadlines = std::max<size_t>(1, static_cast<size_t>(std::stoull(*value)));
+  }
   if (auto value = get("--ants")) {
     options.ants = static_cast<size_t>(std::stoull(*value));
     if (options.ants == 0) {
@@ -131,110 +214,744 @@ Options ParseArgs(int argc, char** argv) {
       options.max_out_degree = 1;
     }
   }
+  if (auto value = get("--annealing")) {
+    options.annealing = *value != "false";
+  }
+  if (auto value = get("--annealing-steps")) {
+    options.annealing_steps = static_cast<size_t>(std::stoull(*value));
+  }
+  if (auto value = get("--instance")) {
+    options.instance = *value;
+    if (options.instance != "sparse" && options.instance != "uniform" &&
+        options.instance != "clustered") {
+      throw std::invalid_argument("Unknown instance kind: " + options.instance);
+    }
+  }
+  if (auto value = get("--asymmetry")) {
+    options.asymmetry = std::stod(*value);
+  }
+  if (auto value = get("--cache-dir")) {
+    options.cache_dir = *value;
+  }
+  if (auto value = get("--counters")) {
+    options.counters = *value != "false";
+  }
+  if (auto value = get("--worker-counters")) {
+    options.worker_counters = *value != "false";
+  }
+  if (auto value = get("--trace")) {
+    options.trace_path = *value;
+  }
+  if (auto value = get("--baseline")) {
+    options.baseline = *value;
+  }
+  if (auto value = get("--regression-threshold")) {
+    options.regression_threshold = std::stod(*value);
+  }
+  if (auto value = get("--scaling")) {
+    options.scaling = *value;
+    if (options.scaling != "strong" && options.scaling != "weak") {
+      throw std::invalid_argument("Unknown scaling mode: " + options.scaling);
+    }
+  }
 
   return options;
 }
 
-std::string GenerateGraphviz(size_t vertices,
-                             unsigned int seed,
-                             size_t max_out_degree) {
-  if (vertices < 2) {
-    throw std::invalid_argument("Graph must have at least two vertices");
+lr4::Graph BuildGraph(const Options& options, size_t vertices, unsigned int seed) {
+  lr4::GeneratorParameters generator;
+  generator.vertices = vertices;
+  generator.seed = seed;
+  generator.max_out_degree = options.max_out_degree;
+  const size_t threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+  lr4::Graph graph;
+  if (options.instance == "uniform") {
+    graph = lr4::GenerateUniformEuclidean(generator, threads);
+  } else if (options.instance == "clustered") {
+    graph = lr4::GenerateClusteredEuclidean(generator, threads);
+  } else {
+    graph = lr4::GenerateSparseDigraph(generator, threads);
   }
-  std::mt19937 rng(seed);
-  std::uniform_real_distribution<double> weight_dist(1.0, 100.0);
-  std::uniform_int_distribution<size_t> extra_dist(0, max_out_degree > 0 ? max_out_degree - 1 : 0);
-  std::uniform_int_distribution<size_t> vertex_dist(0, vertices - 1);
-
-  std::vector<std::unordered_map<size_t, double>> adjacency(vertices);
+  if (options.asymmetry > 0.0) {
+    graph = lr4::PerturbAsymmetric(graph, options.asymmetry, seed, threads);
+  }
+  return graph;
+}
 
-  auto add_edge = [&](size_t from, size_t to) {
-    if (from == to) {
-      return;
+// With --cache-dir, instances are cached in the binary graph format, keyed by
+// everything that determines them; later runs map the file instead of
+// generating the graph again. Dense instances take 8 n^2 bytes (392 MB at
+// 7000 vertices), so the cache is off by default. A cache that cannot be
+// written only costs the speed-up: the graph already built is used.
+lr4::Graph LoadOrBuildGraph(const Options& options, size_t vertices, unsigned int seed) {
+  if (options.cache_dir.empty()) {
+    return BuildGraph(options, vertices, seed);
+  }
+  std::ostringstream name;
+  name << options.instance;
+  if (options.asymmetry > 0.0) {
+    name << "-asym" << options.asymmetry;
+  }
+  name << "-n" << vertices << "-s" << seed << "-d" << options.max_out_degree << ".lr4g";
+  std::filesystem::path path = std::filesystem::path(options.cache_dir) / name.str();
+  if (std::filesystem::exists(path)) {
+    try {
+      lr4::Graph graph = lr4::Graph::FromBinaryFile(path.string());
+      std::cout << "  граф загружен из кэша " << path.string() << std::endl;
+      return graph;
+    } catch (const std::exception& ex) {
+      std::cerr << "  Кэш не прочитан, граф будет построен заново: " << ex.what() << std::endl;
     }
-    double weight = weight_dist(rng);
-    adjacency[from].emplace(to, weight);
-  };
-
-  // Ensure at least one Hamiltonian cycle exists.
-  for (size_t i = 0; i < vertices; ++i) {
-    size_t next = (i + 1) % vertices;
-    add_edge(i, next);
   }
+  lr4::Graph graph = BuildGraph(options, vertices, seed);
+  // Written under a temporary name first, so a concurrent or interrupted run
+  // never sees a partial file.
+  std::filesystem::path temporary = path;
+  temporary += ".tmp" + std::to_string(::getpid());
+  try {
+    std::filesystem::create_directories(options.cache_dir);
+    graph.SaveBinary(temporary.string());
+    std::filesystem::rename(temporary, path);
+  } catch (const std::exception& ex) {
+    std::cerr << "  Граф не сохранён в кэш: " << ex.what() << std::endl;
+    std::error_code ignored;
+    std::filesystem::remove(temporary, ignored);
+  }
+  return graph;
+}
 
-  for (size_t i = 0; i < vertices; ++i) {
-    size_t desired_out_degree = 1;
-    if (max_out_degree > 1) {
-      desired_out_degree += extra_dist(rng);
-      desired_out_degree = std::min(desired_out_degree, max_out_degree);
+// Resets the peak resident set size of the process (Linux >= 4.0), so the
+// next PeakRssMb() covers only what follows. False if the kernel refused.
+bool ResetPeakRss() {
+  std::ofstream clear_refs("/proc/self/clear_refs");
+  clear_refs << "5";
+  clear_refs.flush();
+  return static_cast<bool>(clear_refs);
+}
+
+// Peak resident set size in MiB: VmHWM, or ru_maxrss where /proc is missing.
+double PeakRssMb() {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.rfind("VmHWM:", 0) == 0) {
+      return std::stod(line.substr(6)) / 1024.0;
     }
-    while (adjacency[i].size() < desired_out_degree) {
-      size_t candidate = vertex_dist(rng);
-      if (candidate == i) {
-        continue;
-      }
-      if (adjacency[i].find(candidate) != adjacency[i].end()) {
-        continue;
-      }
-      add_edge(i, candidate);
+  }
+  struct rusage usage;
+  if (::getrusage(RUSAGE_SELF, &usage) == 0) {
+    return static_cast<double>(usage.ru_maxrss) / 1024.0;
+  }
+  return 0.0;
+}
+
+// Elapsed times and best-length traces of the measured runs of one series,
+// with hardware counters averaged per run: over all threads of the process,
+// and for RunParallel also per worker thread. Memory covers the whole
+// series, warm-up included, and the graph the solver works on.
+struct Series {
+  std::vector<double> samples_ms;
+  std::vector<std::vector<lr4::TracePoint>> traces;
+  lr4::CounterValues counters;
+  std::vector<lr4::CounterValues> worker_counters;
+  double peak_rss_mb = 0.0;
+  double allocations_per_iteration = 0.0;
+  double allocated_bytes_per_iteration = 0.0;
+};
+
+// Opens counters on every RunParallel worker for the duration of its share
+// of an iteration and sums them per worker index. The counter objects are
+// created up front and reopened on each worker thread, so the observer adds
+// no heap allocations to the measured runs. Each worker only touches its own
+// slot, so no locking is needed.
+class WorkerCounters : public lr4::WorkerObserver {
+ public:
+  explicit WorkerCounters(size_t threads) : totals_(threads), seen_(threads, 0) {
+    counters_.reserve(threads);
+    for (size_t t = 0; t < threads; ++t) {
+      counters_.push_back(std::make_unique<lr4::PerfCounters>(false, false));
     }
   }
 
-  std::ostringstream oss;
-  oss << "digraph G {\n";
-  oss << std::fixed << std::setprecision(6);
-  for (size_t i = 0; i < vertices; ++i) {
-    oss << "  v" << i << ";\n";
+  void OnWorkerStart(size_t worker) override {
+    counters_[worker]->Open();
+    counters_[worker]->Start();
   }
-  for (size_t from = 0; from < vertices; ++from) {
-    for (const auto& [to, weight] : adjacency[from]) {
-      oss << "  v" << from << " -> v" << to << " [weight=" << weight << "];\n";
+
+  void OnWorkerStop(size_t worker) override {
+    lr4::CounterValues values = counters_[worker]->Stop();
+    counters_[worker]->Close();
+    if (seen_[worker]++ == 0) {
+      totals_[worker] = values;
+    } else {
+      totals_[worker] += values;
     }
   }
-  oss << "}\n";
-  return oss.str();
-}
 
-lr4::Graph BuildGraph(size_t vertices,
-                      unsigned int seed,
-                      size_t max_out_degree) {
-  std::string graphviz = GenerateGraphviz(vertices, seed, max_out_degree);
-  std::istringstream input(graphviz);
-  return lr4::Graph::FromGraphviz(input);
-}
+  void Clear() {
+    std::fill(seen_.begin(), seen_.end(), 0);
+    std::fill(totals_.begin(), totals_.end(), lr4::CounterValues());
+  }
+
+  const std::vector<lr4::CounterValues>& Totals() const { return totals_; }
+
+ private:
+  std::vector<std::unique_ptr<lr4::PerfCounters>> counters_;
+  std::vector<lr4::CounterValues> totals_;
+  std::vector<size_t> seen_;
+};
 
 struct Measurement {
   size_t vertices = 0;
   std::string variant;
   size_t threads = 0;
-  double average_ms = 0.0;
+  Series series;
+  lr4::SampleSummary summary;
 };
 
-double RunSequential(const lr4::AntColonySolver& solver,
-                     const lr4::AntColonyParameters& base_params,
-                     size_t runs) {
-  double total = 0.0;
+// Runs `run_once` `warmup` times untimed with the seed offset of the first
+// run, then `runs` times, and collects the measured runs. With `counters`,
+// each measured run is counted over the whole process, including the threads
+// the solver spawns; `workers`, if given, is the observer passed to
+// RunParallel and is cleared after the warm-up. Heap allocations of the
+// measured runs are reported per iteration, a run having `iterations` of them.
+template <typename RunOnce>
+Series Sample(size_t warmup, size_t runs, size_t iterations, bool counters,
+              WorkerCounters* workers, RunOnce run_once) {
+  ResetPeakRss();
+  lr4::TraceTracks tracks("benchmark", 0);
+  for (size_t run = 0; run < warmup; ++run) {
+    lr4::TraceSpan span(tracks.recorder(), tracks.Main(), "warmup");
+    run_once(size_t{0});
+  }
+  if (workers != nullptr) {
+    workers->Clear();
+  }
+  std::unique_ptr<lr4::PerfCounters> perf;
+  if (counters) {
+    perf = std::make_unique<lr4::PerfCounters>(true);
+  }
+  Series series;
+  series.samples_ms.reserve(runs);
+  series.traces.reserve(runs);
+  size_t allocations = 0;
+  size_t allocated_bytes = 0;
   for (size_t run = 0; run < runs; ++run) {
+    lr4::TraceSpan span(tracks.recorder(), tracks.Main(), "run");
+    const size_t allocations_before = g_allocations.load();
+    const size_t bytes_before = g_allocated_bytes.load();
+    if (perf) {
+      perf->Start();
+    }
+    lr4::TourResult result = run_once(run);
+    allocations += g_allocations.load() - allocations_before;
+    allocated_bytes += g_allocated_bytes.load() - bytes_before;
+    if (perf) {
+      lr4::CounterValues values = perf->Stop();
+      if (run == 0) {
+        series.counters = values;
+      } else {
+        series.counters += values;
+      }
+    }
+    series.samples_ms.push_back(result.elapsed_ms);
+    series.traces.push_back(std::move(result.trace));
+  }
+  const double per_run = 1.0 / static_cast<double>(runs);
+  const double per_iteration = per_run / static_cast<double>(std::max<size_t>(1, iterations));
+  series.peak_rss_mb = PeakRssMb();
+  series.allocations_per_iteration = static_cast<double>(allocations) * per_iteration;
+  series.allocated_bytes_per_iteration = static_cast<double>(allocated_bytes) * per_iteration;
+  series.counters = series.counters.Scaled(per_run);
+  if (workers != nullptr) {
+    for (const lr4::CounterValues& total : workers->Totals()) {
+      series.worker_counters.push_back(total.Scaled(per_run));
+    }
+  }
+  return series;
+}
+
+Series RunSequential(const lr4::AntColonySolver& solver,
+                     const lr4::AntColonyParameters& base_params,
+                     size_t warmup,
+                     size_t runs,
+                     bool counters) {
+  return Sample(warmup, runs, base_params.iterations, counters, nullptr, [&](size_t run) {
     lr4::AntColonyParameters params = base_params;
     params.seed += static_cast<unsigned int>(run);
-    lr4::TourResult result = solver.RunSequential(params);
-    total += result.elapsed_ms;
-  }
-  return total / static_cast<double>(runs);
+    return solver.RunSequential(params);
+  });
 }
 
-double RunParallel(const lr4::AntColonySolver& solver,
+Series RunParallel(const lr4::AntColonySolver& solver,
                    const lr4::AntColonyParameters& base_params,
+                   size_t warmup,
                    size_t runs,
-                   size_t threads) {
-  double total = 0.0;
-  for (size_t run = 0; run < runs; ++run) {
+                   size_t threads,
+                   bool counters,
+                   bool worker_counters) {
+  WorkerCounters workers(threads);
+  WorkerCounters* observer = counters && worker_counters ? &workers : nullptr;
+  return Sample(warmup, runs, base_params.iterations, counters, observer, [&](size_t run) {
     lr4::AntColonyParameters params = base_params;
     params.seed += static_cast<unsigned int>(run);
-    lr4::TourResult result = solver.RunParallel(params, threads);
-    total += result.elapsed_ms;
+    return solver.RunParallel(params, threads, nullptr, observer);
+  });
+}
+
+Series RunAnnealing(const lr4::AnnealingSolver& solver,
+                    const lr4::AnnealingParameters& base_params,
+                    size_t warmup,
+                    size_t runs,
+                    size_t threads,
+                    bool counters) {
+  // An annealing iteration is one round between replica exchanges.
+  const size_t rounds = base_params.steps / std::max<size_t>(1, base_params.exchange_interval);
+  return Sample(warmup, runs, rounds, counters, nullptr, [&](size_t run) {
+    lr4::AnnealingParameters params = base_params;
+    params.seed += static_cast<unsigned int>(run);
+    return solver.Run(params, threads);
+  });
+}
+
+Measurement Measure(size_t vertices, std::string variant, size_t threads, Series series) {
+  Measurement measurement{vertices, std::move(variant), threads, std::move(series), {}};
+  measurement.summary = lr4::Summarize(measurement.series.samples_ms);
+  const lr4::SampleSummary& summary = measurement.summary;
+  const std::streamsize precision = std::cout.precision(4);
+  std::cout << " медиана " << summary.median << " мс (95% ДИ "
+            << summary.median_ci_low << "–" << summary.median_ci_high << ", p90 "
+            << summary.p90 << ", σ " << summary.stddev << ", выбросов " << summary.outliers
+            << ")" << std::endl;
+  std::cout << "    пик RSS " << measurement.series.peak_rss_mb
+            << " МБ, выделений памяти на итерацию " << measurement.series.allocations_per_iteration
+            << " (" << measurement.series.allocated_bytes_per_iteration / (1024.0 * 1024.0)
+            << " МБ)" << std::endl;
+  const lr4::CounterValues& counters = measurement.series.counters;
+  if (counters.Any()) {
+    auto show = [](double value) {
+      std::ostringstream text;
+      if (value < 0.0) {
+        text << "н/д";
+      } else {
+        text << std::setprecision(3) << value;
+      }
+      return text.str();
+    };
+    std::cout << "    IPC " << show(counters.Ipc())
+              << ", промахов L1d " << show(counters.Get(lr4::Counter::kL1dMisses))
+              << ", LLC " << show(counters.Get(lr4::Counter::kLlcMisses))
+              << ", ветвлений " << show(counters.Get(lr4::Counter::kBranchMisses))
+              << ", переключений контекста " << show(counters.Get(lr4::Counter::kContextSwitches))
+              << " за запуск" << std::endl;
+    if (!measurement.series.worker_counters.empty()) {
+      std::cout << "    IPC по потокам:";
+      for (const lr4::CounterValues& worker : measurement.series.worker_counters) {
+        std::cout << ' ' << show(worker.Ipc());
+      }
+      std::cout << std::endl;
+    }
+  }
+  std::cout.precision(precision);
+  return measurement;
+}
+
+// Counter columns of the CSV outputs; a missing counter leaves its cell empty.
+const char* const kCounterHeader =
+    "cycles,instructions,ipc,l1d_misses,llc_misses,branch_misses,context_switches";
+
+void WriteCounterCells(std::ostream& out, const lr4::CounterValues& counters) {
+  auto cell = [&out](double value) {
+    out << ',';
+    if (value >= 0.0) {
+      out << value;
+    }
+  };
+  cell(counters.Get(lr4::Counter::kCycles));
+  cell(counters.Get(lr4::Counter::kInstructions));
+  cell(counters.Ipc());
+  cell(counters.Get(lr4::Counter::kL1dMisses));
+  cell(counters.Get(lr4::Counter::kLlcMisses));
+  cell(counters.Get(lr4::Counter::kBranchMisses));
+  cell(counters.Get(lr4::Counter::kContextSwitches));
+}
+
+// Distinct (physical id, core id) pairs in /proc/cpuinfo; the logical core
+// count where the file does not list them.
+size_t PhysicalCoreCount() {
+  std::ifstream cpuinfo("/proc/cpuinfo");
+  std::set<std::pair<std::string, std::string>> cores;
+  std::string package;
+  std::string line;
+  while (std::getline(cpuinfo, line)) {
+    size_t colon = line.find(':');
+    if (colon == std::string::npos) {
+      continue;
+    }
+    std::string value = colon + 2 <= line.size() ? line.substr(colon + 2) : "";
+    if (line.rfind("physical id", 0) == 0) {
+      package = value;
+    } else if (line.rfind("core id", 0) == 0) {
+      cores.emplace(package, value);
+    }
+  }
+  if (cores.empty()) {
+    return std::max<size_t>(1, std::thread::hardware_concurrency());
+  }
+  return cores.size();
+}
+
+struct HostInfo {
+  std::string cpu_model = "unknown";
+  size_t logical_cores = 0;
+  size_t physical_cores = 0;
+  std::string kernel = "unknown";
+  std::string compiler;
+  std::string build_flags;
+  std::string timestamp;
+};
+
+HostInfo CollectHostInfo() {
+  HostInfo host;
+  std::ifstream cpuinfo("/proc/cpuinfo");
+  std::string line;
+  while (std::getline(cpuinfo, line)) {
+    if (line.rfind("model name", 0) == 0) {
+      size_t colon = line.find(':');
+      if (colon != std::string::npos) {
+        host.cpu_model = line.substr(colon + 2);
+      }
+      break;
+    }
+  }
+  host.logical_cores = std::max<size_t>(1, std::thread::hardware_concurrency());
+  host.physical_cores = PhysicalCoreCount();
+  struct utsname name;
+  if (::uname(&name) == 0) {
+    host.kernel = std::string(name.sysname) + " " + name.release;
+  }
+#if defined(__clang__)
+  host.compiler = "clang " __clang_version__;
+#elif defined(__GNUC__)
+  host.compiler = "gcc " __VERSION__;
+#else
+  host.compiler = "unknown";
+#endif
+  host.build_flags = LR4_BUILD_FLAGS;
+  std::time_t now = std::time(nullptr);
+  char buffer[32];
+  std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+  host.timestamp = buffer;
+  return host;
+}
+
+std::string JsonString(std::string_view text) {
+  std::string quoted = "\"";
+  for (char ch : text) {
+    if (ch == '"' || ch == '\\') {
+      quoted.push_back('\\');
+      quoted.push_back(ch);
+    } else if (static_cast<unsigned char>(ch) < 0x20) {
+      char escaped[8];
+      std::snprintf(escaped, sizeof(escaped), "\\u%04x", ch);
+      quoted += escaped;
+    } else {
+      quoted.push_back(ch);
+    }
+  }
+  quoted.push_back('"');
+  return quoted;
+}
+
+// JSON object with the available counters and IPC, or null.
+std::string JsonCounters(const lr4::CounterValues& counters) {
+  if (!counters.Any()) {
+    return "null";
+  }
+  std::ostringstream json;
+  json << std::setprecision(9) << '{';
+  const char* separator = "";
+  for (size_t i = 0; i < lr4::kCounterCount; ++i) {
+    lr4::Counter counter = static_cast<lr4::Counter>(i);
+    if (counters.Has(counter)) {
+      json << separator << '"' << lr4::CounterName(counter) << "\": " << counters.Get(counter);
+      separator = ", ";
+    }
+  }
+  if (counters.Ipc() >= 0.0) {
+    json << separator << "\"ipc\": " << counters.Ipc();
+  }
+  json << '}';
+  return json.str();
+}
+
+void WriteJson(const std::string& path, const Options& options, const HostInfo& host,
+               const std::vector<Measurement>& results) {
+  std::ofstream json(path);
+  if (!json) {
+    throw std::runtime_error("Unable to open output file: " + path);
+  }
+  json << std::setprecision(9);
+  json << "{\n  \"host\": {\n"
+       << "    \"cpu_model\": " << JsonString(host.cpu_model) << ",\n"
+       << "    \"logical_cores\": " << host.logical_cores << ",\n"
+       << "    \"physical_cores\": " << host.physical_cores << ",\n"
+       << "    \"kernel\": " << JsonString(host.kernel) << ",\n"
+       << "    \"compiler\": " << JsonString(host.compiler) << ",\n"
+       << "    \"build_flags\": " << JsonString(host.build_flags) << ",\n"
+       << "    \"timestamp\": " << JsonString(host.timestamp) << "\n  },\n";
+  json << "  \"config\": {\n"
+       << "    \"instance\": " << JsonString(options.instance) << ",\n"
+       << "    \"runs\": " << options.runs << ",\n"
+       << "    \"warmup\": " << options.warmup << ",\n"
+       << "    \"scaling\": " << JsonString(options.scaling) << ",\n"
+       << "    \"ants\": " << options.ants << ",\n"
+       << "    \"iterations\": " << options.iterations << ",\n"
+       << "    \"seed\": " << options.seed << ",\n"
+       << "    \"max_out_degree\": " << options.max_out_degree << "\n  },\n";
+  json << "  \"results\": [";
+  for (size_t i = 0; i < results.size(); ++i) {
+    const Measurement& measurement = results[i];
+    const lr4::SampleSummary& summary = measurement.summary;
+    json << (i == 0 ? "\n" : ",\n")
+         << "    {\"vertices\": " << measurement.vertices
+         << ", \"variant\": " << JsonString(measurement.variant)
+         << ", \"threads\": " << measurement.threads
+         << ", \"mean_ms\": " << summary.mean
+         << ", \"median_ms\": " << summary.median
+         << ", \"p90_ms\": " << summary.p90
+         << ", \"p99_ms\": " << summary.p99
+         << ", \"min_ms\": " << summary.min
+         << ", \"max_ms\": " << summary.max
+         << ", \"stddev_ms\": " << summary.stddev
+         << ", \"median_ci95_ms\": [" << summary.median_ci_low << ", " << summary.median_ci_high
+         << "], \"outliers\": " << summary.outliers
+         << ", \"peak_rss_mb\": " << measurement.series.peak_rss_mb
+         << ", \"allocations_per_iteration\": " << measurement.series.allocations_per_iteration
+         << ", \"allocated_bytes_per_iteration\": "
+         << measurement.series.allocated_bytes_per_iteration
+         << ", \"samples_ms\": [";
+    for (size_t k = 0; k < measurement.series.samples_ms.size(); ++k) {
+      json << (k == 0 ? "" : ", ") << measurement.series.samples_ms[k];
+    }
+    json << "], \"counters\": " << JsonCounters(measurement.series.counters);
+    if (!measurement.series.worker_counters.empty()) {
+      json << ", \"worker_counters\": [";
+      for (size_t t = 0; t < measurement.series.worker_counters.size(); ++t) {
+        json << (t == 0 ? "" : ", ") << JsonCounters(measurement.series.worker_counters[t]);
+      }
+      json << "]";
+    }
+    json << "}";
   }
-  return total / static_cast<double>(runs);
+  json << "\n  ]\n}\n";
+}
+
+// Writes <stem>_traces.csv with the raw best-length traces, <stem>_ttt.csv
+// with time-to-target and <stem>_quality.csv with quality-at-deadline per
+// variant and thread count. Targets and qualities are ratios to the best
+// final length any run reached on the same instance; a run that never
+// reaches a target counts as infinitely slow.
+void WriteQualityProfiles(const std::string& stem, const Options& options,
+                          const std::vector<Measurement>& results) {
+  auto open = [](const std::string& path) {
+    std::ofstream file(path);
+    if (!file) {
+      throw std::runtime_error("Unable to open output file: " + path);
+    }
+    file << std::setprecision(9);
+    return file;
+  };
+  std::ofstream traces = open(stem + "_traces.csv");
+  std::ofstream ttt = open(stem + "_ttt.csv");
+  std::ofstream quality = open(stem + "_quality.csv");
+  traces << "vertices,variant,threads,run,elapsed_ms,best_length\n";
+  ttt << "vertices,variant,threads,target_ratio,reached_fraction,median_ms,p90_ms\n";
+  quality << "vertices,variant,threads,deadline_ms,median_ratio,p90_ratio,feasible_fraction\n";
+
+  std::map<size_t, double> reference;
+  std::map<size_t, std::pair<double, double>> horizon;
+  for (const Measurement& measurement : results) {
+    auto [reference_it, inserted] =
+        reference.emplace(measurement.vertices, std::numeric_limits<double>::infinity());
+    auto [horizon_it, unused] = horizon.emplace(
+        measurement.vertices, std::make_pair(std::numeric_limits<double>::infinity(), 0.0));
+    for (size_t run = 0; run < measurement.series.traces.size(); ++run) {
+      const std::vector<lr4::TracePoint>& trace = measurement.series.traces[run];
+      if (!trace.empty()) {
+        reference_it->second = std::min(reference_it->second, trace.back().best_length);
+        horizon_it->second.first = std::min(horizon_it->second.first, trace.front().elapsed_ms);
+      }
+      horizon_it->second.second =
+          std::max(horizon_it->second.second, measurement.series.samples_ms[run]);
+    }
+  }
+
+  for (const Measurement& measurement : results) {
+    const std::string key = std::to_string(measurement.vertices) + "," + measurement.variant +
+                            "," + std::to_string(measurement.threads) + ",";
+    const std::vector<std::vector<lr4::TracePoint>>& runs = measurement.series.traces;
+    for (size_t run = 0; run < runs.size(); ++run) {
+      for (const lr4::TracePoint& point : runs[run]) {
+        traces << key << run << ',' << point.elapsed_ms << ',' << point.best_length << "\n";
+      }
+    }
+    const double best = reference[measurement.vertices];
+    if (!std::isfinite(best) || runs.empty()) {
+      continue;
+    }
+    for (double target : options.targets) {
+      std::vector<double> times;
+      size_t reached = 0;
+      for (const auto& trace : runs) {
+        times.push_back(lr4::TimeToTarget(trace, best * target));
+        reached += std::isfinite(times.back()) ? 1 : 0;
+      }
+      std::sort(times.begin(), times.end());
+      ttt << key << target << ',' << static_cast<double>(reached) / runs.size() << ','
+          << lr4::Percentile(times, 0.5) << ',' << lr4::Percentile(times, 0.9) << "\n";
+    }
+    // Deadlines are spaced geometrically between the earliest first
+    // solution and the slowest run on this instance.
+    const auto [first_ms, last_ms] = horizon[measurement.vertices];
+    const double low = std::max(first_ms, 1e-3);
+    const double high = std::max(last_ms, low);
+    for (size_t step = 0; step < options.deadlines; ++step) {
+      const double position =
+          options.deadlines > 1 ? static_cast<double>(step) / (options.deadlines - 1) : 1.0;
+      const double deadline = low * std::pow(high / low, position);
+      std::vector<double> ratios;
+      size_t feasible = 0;
+      for (const auto& trace : runs) {
+        ratios.push_back(lr4::QualityAt(trace, deadline) / best);
+        feasible += std::isfinite(ratios.back()) ? 1 : 0;
+      }
+      std::sort(ratios.begin(), ratios.end());
+      quality << key << deadline << ',' << lr4::Percentile(ratios, 0.5) << ','
+              << lr4::Percentile(ratios, 0.9) << ','
+              << static_cast<double>(feasible) / runs.size() << "\n";
+    }
+  }
+}
+
+// Strong scaling divides the same colony among more threads; weak scaling
+// gives every thread options.ants ants. Speedups are relative to the
+// sequential run of the same size (options.ants ants) and, for weak scaling,
+// are scaled speedups p T(1) / T(p). Writes <stem>_scaling.csv with the
+// fitted Amdahl (strong) or Gustafson (weak) model next to the measurements.
+void WriteScaling(const std::string& stem, const Options& options,
+                  const std::vector<Measurement>& results) {
+  std::ofstream csv(stem + "_scaling.csv");
+  if (!csv) {
+    throw std::runtime_error("Unable to open output file: " + stem + "_scaling.csv");
+  }
+  const bool weak = options.scaling == "weak";
+  csv << "vertices,mode,threads,ants,median_ms,speedup,efficiency,model_speedup\n";
+  csv << std::setprecision(9);
+  std::cout << (weak ? "Слабая" : "Сильная") << " масштабируемость:\n";
+  std::map<size_t, double> sequential;
+  for (const Measurement& measurement : results) {
+    if (measurement.variant == "sequential") {
+      sequential[measurement.vertices] = measurement.summary.median;
+    }
+  }
+  for (const auto& [vertices, serial_ms] : sequential) {
+    std::vector<const Measurement*> rows;
+    std::vector<size_t> threads;
+    std::vector<double> speedups;
+    for (const Measurement& measurement : results) {
+      if (measurement.vertices == vertices && measurement.variant == "parallel") {
+        const double p = static_cast<double>(measurement.threads);
+        const double ratio = serial_ms / measurement.summary.median;
+        rows.push_back(&measurement);
+        threads.push_back(measurement.threads);
+        speedups.push_back(weak ? p * ratio : ratio);
+      }
+    }
+    const double serial_fraction = weak ? lr4::GustafsonSerialFraction(threads, speedups)
+                                        : lr4::AmdahlSerialFraction(threads, speedups);
+    std::cout << "  " << vertices << " вершин: доля последовательной части " << std::setprecision(3)
+              << serial_fraction;
+    if (!weak && serial_fraction > 0.0) {
+      std::cout << ", предел ускорения " << 1.0 / serial_fraction;
+    }
+    std::cout << "\n   ";
+    for (size_t i = 0; i < rows.size(); ++i) {
+      const double p = static_cast<double>(threads[i]);
+      const double model = weak ? p - serial_fraction * (p - 1.0)
+                                : 1.0 / (serial_fraction + (1.0 - serial_fraction) / p);
+      csv << vertices << ',' << options.scaling << ',' << threads[i] << ','
+          << (weak ? options.ants * threads[i] : options.ants) << ','
+          << rows[i]->summary.median << ',' << speedups[i] << ',' << speedups[i] / p << ','
+          << model << "\n";
+      std::cout << ' ' << threads[i] << ": ×" << std::setprecision(3) << speedups[i] << " ("
+                << std::lround(100.0 * speedups[i] / p) << "%)";
+    }
+    std::cout << "\n";
+  }
+}
+
+lr4::Baseline LoadBaseline(const std::string& path) {
+  std::ifstream input(path);
+  if (!input) {
+    throw std::runtime_error("Unable to open baseline file: " + path);
+  }
+  try {
+    return lr4::ParseBaseline(input);
+  } catch (const std::exception& ex) {
+    throw std::runtime_error(path + ": " + ex.what());
+  }
+}
+
+// Prints the change of every median against the baseline (see
+// lr4::CompareMedians) and returns whether any configuration regressed.
+// A baseline that shares no configuration with this run is an error: the
+// regression gate would otherwise pass without comparing anything.
+bool CompareWithBaseline(const std::vector<Measurement>& results, const lr4::Baseline& baseline,
+                         double threshold) {
+  std::cout << "Сравнение с базовой линией (порог " << std::setprecision(3) << 100.0 * threshold
+            << "%):\n";
+  bool regressed = false;
+  size_t matched = 0;
+  for (const Measurement& measurement : results) {
+    auto it = baseline.find({measurement.vertices, measurement.variant, measurement.threads});
+    if (it == baseline.end() || !(it->second.median_ms > 0.0)) {
+      continue;
+    }
+    ++matched;
+    const lr4::MedianChange change =
+        lr4::CompareMedians(it->second, measurement.summary, threshold);
+    regressed = regressed || change.regression;
+    std::cout << "  " << measurement.vertices << " вершин, " << measurement.variant << ", "
+              << measurement.threads << " потоков: " << std::showpos << std::fixed
+              << std::setprecision(1) << 100.0 * change.change << "% [" << 100.0 * change.low
+              << "%, " << 100.0 * change.high << "%]" << std::noshowpos << std::defaultfloat;
+    if (change.regression) {
+      std::cout << "  РЕГРЕССИЯ";
+    } else if (change.improvement) {
+      std::cout << "  ускорение";
+    }
+    std::cout << "\n";
+  }
+  if (matched == 0) {
+    throw std::runtime_error("Baseline shares no configuration with this run");
+  }
+  return regressed;
+}
+
+// Thread counts of the scaling sweep: powers of two up to the logical core
+// count, the physical core count and the logical core count itself.
+std::vector<size_t> ScalingThreadCounts() {
+  const size_t logical = std::max<size_t>(1, std::thread::hardware_concurrency());
+  std::vector<size_t> thread_counts;
+  for (size_t threads = 1; threads <= logical; threads *= 2) {
+    thread_counts.push_back(threads);
+  }
+  thread_counts.push_back(std::min(PhysicalCoreCount(), logical));
+  thread_counts.push_back(logical);
+  std::sort(thread_counts.begin(), thread_counts.end());
+  thread_counts.erase(std::unique(thread_counts.begin(), thread_counts.end()), thread_counts.end());
+  return thread_counts;
 }
 
 std::vector<size_t> DetermineThreadCounts() {
@@ -253,7 +970,14 @@ std::vector<size_t> DetermineThreadCounts() {
 int main(int argc, char** argv) {
   try {
     Options options = ParseArgs(argc, argv);
-    std::vector<size_t> thread_counts = DetermineThreadCounts();
+    lr4::ScopedTraceFile trace(options.trace_path);
+    std::vector<size_t> thread_counts =
+        options.scaling.empty() ? DetermineThreadCounts() : ScalingThreadCounts();
+    // Loaded up front, so a bad path fails before the long runs.
+    lr4::Baseline baseline;
+    if (!options.baseline.empty()) {
+      baseline = LoadBaseline(options.baseline);
+    }
 
     std::vector<Measurement> results;
     results.reserve(options.sizes.size() * (thread_counts.size() + 1));
@@ -267,13 +991,28 @@ int main(int argc, char** argv) {
       }
       std::cout << thread_counts[i];
     }
-    std::cout << "\n\n";
+    std::cout << "\n";
+    if (options.counters) {
+      lr4::PerfCounters probe(false);
+      if (!probe.Available()) {
+        std::cout << "Счётчики производительности недоступны (" << probe.Error()
+                  << "), их столбцы останутся пустыми\n";
+        options.counters = false;
+      } else if (!probe.Error().empty()) {
+        std::cout << "Часть счётчиков производительности недоступна (" << probe.Error() << ")\n";
+      }
+    }
+    if (!ResetPeakRss()) {
+      std::cout << "Пик RSS не сбрасывается (/proc/self/clear_refs), столбец peak_rss_mb "
+                   "содержит пик процесса с начала работы\n";
+    }
+    std::cout << "\n";
 
     for (size_t index = 0; index < options.sizes.size(); ++index) {
       size_t vertices = options.sizes[index];
       unsigned int graph_seed = options.seed + static_cast<unsigned int>(index * 9973);
       std::cout << "Готовим граф на " << vertices << " вершинах..." << std::endl;
-      lr4::Graph graph = BuildGraph(vertices, graph_seed, options.max_out_degree);
+      lr4::Graph graph = LoadOrBuildGraph(options, vertices, graph_seed);
       lr4::AntColonySolver solver(graph);
 
       lr4::AntColonyParameters params;
@@ -286,15 +1025,34 @@ int main(int argc, char** argv) {
       params.seed = options.seed;
 
       std::cout << "  Последовательные запуски..." << std::flush;
-      double seq_avg = RunSequential(solver, params, options.runs);
-      std::cout << " среднее время " << std::setprecision(4) << seq_avg << " мс" << std::endl;
-      results.push_back(Measurement{vertices, "sequential", 1, seq_avg});
+      results.push_back(Measure(vertices, "sequential", 1,
+                                RunSequential(solver, params, options.warmup, options.runs,
+                                              options.counters)));
 
       for (size_t threads : thread_counts) {
-        std::cout << "  Параллельные запуски (" << threads << " потоков)..." << std::flush;
-        double par_avg = RunParallel(solver, params, options.runs, threads);
-        std::cout << " среднее время " << std::setprecision(4) << par_avg << " мс" << std::endl;
-        results.push_back(Measurement{vertices, "parallel", threads, par_avg});
+        lr4::AntColonyParameters parallel_params = params;
+        if (options.scaling == "weak") {
+          parallel_params.ants = options.ants * threads;
+        }
+        std::cout << "  Параллельные запуски (" << threads << " потоков, "
+                  << parallel_params.ants << " муравьёв)..." << std::flush;
+        results.push_back(Measure(vertices, "parallel", threads,
+                                  RunParallel(solver, parallel_params, options.warmup,
+                                              options.runs, threads, options.counters,
+                                              options.worker_counters)));
+      }
+
+      if (options.annealing) {
+        lr4::AnnealingSolver annealing_solver(graph);
+        lr4::AnnealingParameters annealing;
+        annealing.steps = options.annealing_steps;
+        annealing.seed = options.seed;
+        for (size_t threads : thread_counts) {
+          std::cout << "  Имитация отжига (" << threads << " реплик)..." << std::flush;
+          results.push_back(Measure(vertices, "annealing", threads,
+                                    RunAnnealing(annealing_solver, annealing, options.warmup,
+                                                 options.runs, threads, options.counters)));
+        }
       }
 
       std::cout << std::endl;
@@ -304,16 +1062,60 @@ int main(int argc, char** argv) {
     if (!csv) {
       throw std::runtime_error("Unable to open output file: " + options.output);
     }
-    csv << "vertices,variant,threads,average_ms\n";
+    csv << "vertices,variant,threads,average_ms,median_ms,p90_ms,p99_ms,min_ms,stddev_ms,"
+           "median_ci_low_ms,median_ci_high_ms,outliers,peak_rss_mb,allocations_per_iteration,"
+           "allocated_bytes_per_iteration," << kCounterHeader << "\n";
     csv << std::fixed << std::setprecision(6);
     for (const Measurement& measurement : results) {
+      const lr4::SampleSummary& summary = measurement.summary;
       csv << measurement.vertices << ','
           << measurement.variant << ','
           << measurement.threads << ','
-          << measurement.average_ms << "\n";
+          << summary.mean << ','
+          << summary.median << ','
+          << summary.p90 << ','
+          << summary.p99 << ','
+          << summary.min << ','
+          << summary.stddev << ','
+          << summary.median_ci_low << ','
+          << summary.median_ci_high << ','
+          << summary.outliers << ','
+          << measurement.series.peak_rss_mb << ','
+          << measurement.series.allocations_per_iteration << ','
+          << measurement.series.allocated_bytes_per_iteration;
+      WriteCounterCells(csv, measurement.series.counters);
+      csv << "\n";
+    }
+    std::string stem = std::filesystem::path(options.output).replace_extension("").string();
+    std::ofstream threads_csv(stem + "_threads.csv");
+    if (!threads_csv) {
+      throw std::runtime_error("Unable to open output file: " + stem + "_threads.csv");
+    }
+    threads_csv << "vertices,variant,threads,worker," << kCounterHeader << "\n";
+    threads_csv << std::fixed << std::setprecision(6);
+    for (const Measurement& measurement : results) {
+      for (size_t t = 0; t < measurement.series.worker_counters.size(); ++t) {
+        threads_csv << measurement.vertices << ',' << measurement.variant << ','
+                    << measurement.threads << ',' << t;
+        WriteCounterCells(threads_csv, measurement.series.worker_counters[t]);
+        threads_csv << "\n";
+      }
+    }
+    std::string json_path = options.json_output;
+    if (json_path.empty()) {
+      json_path = std::filesystem::path(options.output).replace_extension(".json").string();
+    }
+    WriteJson(json_path, options, CollectHostInfo(), results);
+    WriteQualityProfiles(stem, options, results);
+    if (!options.scaling.empty()) {
+      WriteScaling(stem, options, results);
     }
 
-    std::cout << "Результаты сохранены в " << options.output << std::endl;
+    std::cout << "Результаты сохранены в " << options.output << " и " << json_path << std::endl;
+    if (!options.baseline.empty() &&
+        CompareWithBaseline(results, baseline, options.regression_threshold)) {
+      return kExitRegression;
+    }
     return EXIT_SUCCESS;
   } catch (const std::exception& ex) {
     std::cerr << "Ошибка: " << ex.what() << std::endl;
@@ -0,0 +1,273 @@
+#include "decomposition_solver.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <string>
+
+#include "parallel.h"
+
+namespace lr4 {
+namespace {
+
+constexpr size_t kUnassigned = std::numeric_limits<size_t>::max();
+
+TourCost EdgeCost(const Graph& graph, int from, int to) {
+  TourCost cost;
+  cost.Add(graph.Weight(static_cast<size_t>(from), static_cast<size_t>(to)));
+  return cost;
+}
+
+// Cost of a cycle with the edge `removed` taken out, i.e. of the Hamiltonian
+// path obtained by cutting the cycle at that edge.
+TourCost WithoutEdge(TourCost cycle, const TourCost& removed) {
+  cycle.missing -= removed.missing;
+  cycle.finite -= removed.finite;
+  return cycle;
+}
+
+// Open cycle (without the repeated start vertex) from a colony result, or a
+// greedy one when the colony found nothing.
+std::vector<int> CycleOrGreedy(const Graph& graph, const TourResult& result) {
+  if (!result.best_paths.empty()) {
+    const std::vector<int>& best = result.best_paths.front();
+    return std::vector<int>(best.begin(), best.end() - 1);
+  }
+  std::vector<int> greedy = GreedyTour(graph);
+  greedy.pop_back();
+  return greedy;
+}
+
+}  // namespace
+
+DecompositionSolver::DecompositionSolver(const Graph& graph) : graph_(graph) {}
+
+TourResult DecompositionSolver::Run(const DecompositionParameters& params,
+                                    size_t thread_count) const {
+  TourResult result;
+  if (thread_count == 0 || graph_.VertexCount() == 0) {
+    return result;
+  }
+  auto start = std::chrono::steady_clock::now();
+  const uint64_t start_ticks = ReadTimestamp();
+  PhaseTicks ticks{};
+  uint64_t mark = start_ticks;
+  std::vector<std::vector<size_t>> clusters = Partition(std::max<size_t>(1, params.cluster_size));
+  std::vector<std::vector<int>> cycles(clusters.size());
+  ParallelFor(clusters.size(), thread_count, [&](size_t index, size_t) {
+    unsigned int seed = params.colony.seed + static_cast<unsigned int>(index * 7919);
+    cycles[index] = SolveCluster(clusters[index], params, seed);
+  });
+  std::vector<size_t> order = OrderClusters(cycles, params, thread_count);
+  std::vector<int> tour = Stitch(cycles, order, std::max<size_t>(1, params.entry_candidates));
+  Lap(Phase::kConstruction, &mark, &ticks);
+  ImproveTour(graph_, params.local_search, &tour);
+  Lap(Phase::kLocalSearch, &mark, &ticks);
+  result = SingleTourResult(graph_, tour);
+  const uint64_t end_ticks = ReadTimestamp();
+  auto end = std::chrono::steady_clock::now();
+  result.elapsed_ms = std::chrono::duration<double, std::milli>(end - start).count();
+  result.phase_ms = TicksToMilliseconds(ticks, end_ticks - start_ticks, result.elapsed_ms);
+  return result;
+}
+
+std::vector<std::vector<size_t>> DecompositionSolver::Partition(size_t cluster_size) const {
+  const size_t n = graph_.VertexCount();
+  std::vector<size_t> owner(n, kUnassigned);
+  std::vector<double> link(n);
+  std::vector<std::vector<size_t>> clusters;
+  for (size_t seed = 0; seed < n; ++seed) {
+    if (owner[seed] != kUnassigned) {
+      continue;
+    }
+    const size_t id = clusters.size();
+    std::vector<size_t> cluster;
+    std::fill(link.begin(), link.end(), Graph::kInfinity);
+    size_t added = seed;
+    while (true) {
+      owner[added] = id;
+      cluster.push_back(added);
+      if (cluster.size() >= cluster_size) {
+        break;
+      }
+      // Prim-style growth: attach the unassigned vertex with the cheapest
+      // edge (in either direction) to any member of the cluster.
+      size_t best = kUnassigned;
+      for (size_t v = 0; v < n; ++v) {
+        if (owner[v] != kUnassigned) {
+          continue;
+        }
+        link[v] = std::min({link[v], graph_.Weight(added, v), graph_.Weight(v, added)});
+        if (best == kUnassigned || link[v] < link[best]) {
+          best = v;
+        }
+      }
+      if (best == kUnassigned || !std::isfinite(link[best])) {
+        break;
+      }
+      added = best;
+    }
+    clusters.push_back(std::move(cluster));
+  }
+  return clusters;
+}
+
+std::vector<int> DecompositionSolver::SolveCluster(const std::vector<size_t>& cluster,
+                                                   const DecompositionParameters& params,
+                                                   unsigned int seed) const {
+  Graph subgraph = graph_.Subgraph(cluster);
+  AntColonyParameters colony = params.colony;
+  colony.seed = seed;
+  TourResult local = AntColonySolver(subgraph).RunSequential(colony);
+  std::vector<int> cycle = CycleOrGreedy(subgraph, local);
+  cycle.push_back(cycle.front());
+  ImproveTour(subgraph, params.local_search, &cycle);
+  cycle.pop_back();
+  for (int& vertex : cycle) {
+    vertex = static_cast<int>(cluster[static_cast<size_t>(vertex)]);
+  }
+  return cycle;
+}
+
+std::vector<size_t> DecompositionSolver::OrderClusters(const std::vector<std::vector<int>>& cycles,
+                                                       const DecompositionParameters& params,
+                                                       size_t thread_count) const {
+  const size_t k = cycles.size();
+  std::vector<size_t> order(k);
+  std::iota(order.begin(), order.end(), 0);
+  if (k <= 2) {
+    return order;
+  }
+  const size_t n = graph_.VertexCount();
+  std::vector<size_t> cluster_of(n);
+  for (size_t c = 0; c < k; ++c) {
+    for (int vertex : cycles[c]) {
+      cluster_of[static_cast<size_t>(vertex)] = c;
+    }
+  }
+  // Cluster graph: the cheapest edge leaving one cluster for another.
+  std::vector<std::vector<double>> distances(k, std::vector<double>(k, Graph::kInfinity));
+  ParallelFor(k, thread_count, [&](size_t from, size_t) {
+    std::vector<double>& row = distances[from];
+    row[from] = 0.0;
+    for (int u : cycles[from]) {
+      for (size_t v = 0; v < n; ++v) {
+        size_t to = cluster_of[v];
+        if (to != from) {
+          row[to] = std::min(row[to], graph_.Weight(static_cast<size_t>(u), v));
+        }
+      }
+    }
+  });
+  std::vector<std::string> labels;
+  labels.reserve(k);
+  for (size_t c = 0; c < k; ++c) {
+    labels.push_back("C" + std::to_string(c));
+  }
+  Graph cluster_graph = Graph::FromAdjacency(std::move(labels), std::move(distances));
+  TourResult ordering = AntColonySolver(cluster_graph).RunParallel(params.colony, thread_count);
+  std::vector<int> cycle = CycleOrGreedy(cluster_graph, ordering);
+  for (size_t i = 0; i < k; ++i) {
+    order[i] = static_cast<size_t>(cycle[i]);
+  }
+  return order;
+}
+
+std::vector<int> DecompositionSolver::Stitch(const std::vector<std::vector<int>>& cycles,
+                                             const std::vector<size_t>& order,
+                                             size_t entry_candidates) const {
+  std::vector<int> tour;
+  if (order.empty()) {
+    return tour;
+  }
+  // Start from the smallest cluster: its entry points are enumerated.
+  std::vector<size_t> sequence = order;
+  auto smallest = std::min_element(sequence.begin(), sequence.end(), [&](size_t a, size_t b) {
+    return cycles[a].size() < cycles[b].size();
+  });
+  std::rotate(sequence.begin(), smallest, sequence.end());
+  const size_t k = sequence.size();
+
+  // Entering cluster i at position e means leaving it from the predecessor of
+  // e, so the edge pred(e) -> e is the one cut out of its cycle.
+  std::vector<TourCost> cycle_costs(k);
+  std::vector<std::vector<TourCost>> cut_costs(k);
+  for (size_t i = 0; i < k; ++i) {
+    const std::vector<int>& cycle = cycles[sequence[i]];
+    const size_t s = cycle.size();
+    cut_costs[i].resize(s);
+    for (size_t e = 0; e < s; ++e) {
+      cut_costs[i][e] = EdgeCost(graph_, cycle[(e + s - 1) % s], cycle[e]);
+      cycle_costs[i] = cycle_costs[i] + cut_costs[i][e];
+    }
+  }
+  auto exit_vertex = [&](size_t i, size_t e) {
+    const std::vector<int>& cycle = cycles[sequence[i]];
+    return cycle[(e + cycle.size() - 1) % cycle.size()];
+  };
+  auto entry_vertex = [&](size_t i, size_t e) { return cycles[sequence[i]][e]; };
+
+  // Try the entries of the first cluster whose cut edges are the most expensive.
+  std::vector<size_t> first_entries(cut_costs[0].size());
+  std::iota(first_entries.begin(), first_entries.end(), 0);
+  std::sort(first_entries.begin(), first_entries.end(), [&](size_t a, size_t b) {
+    return cut_costs[0][b] < cut_costs[0][a];
+  });
+  first_entries.resize(std::min(first_entries.size(), entry_candidates));
+
+  TourCost best_total;
+  bool have_best = false;
+  std::vector<size_t> best_entries;
+  for (size_t first : first_entries) {
+    std::vector<std::vector<size_t>> back(k);
+    std::vector<TourCost> layer{WithoutEdge(cycle_costs[0], cut_costs[0][first])};
+    std::vector<size_t> layer_entries{first};
+    for (size_t i = 1; i < k; ++i) {
+      const size_t s = cut_costs[i].size();
+      std::vector<TourCost> next_layer(s);
+      back[i].assign(s, 0);
+      for (size_t e = 0; e < s; ++e) {
+        const int entry = entry_vertex(i, e);
+        for (size_t p = 0; p < layer.size(); ++p) {
+          TourCost cost = layer[p] + EdgeCost(graph_, exit_vertex(i - 1, layer_entries[p]), entry);
+          if (p == 0 || cost < next_layer[e]) {
+            next_layer[e] = cost;
+            back[i][e] = layer_entries[p];
+          }
+        }
+        next_layer[e] = next_layer[e] + WithoutEdge(cycle_costs[i], cut_costs[i][e]);
+      }
+      layer = std::move(next_layer);
+      layer_entries.resize(s);
+      std::iota(layer_entries.begin(), layer_entries.end(), 0);
+    }
+    for (size_t p = 0; p < layer.size(); ++p) {
+      TourCost total = layer[p] + EdgeCost(graph_, exit_vertex(k - 1, layer_entries[p]),
+                                           entry_vertex(0, first));
+      if (!have_best || total < best_total) {
+        have_best = true;
+        best_total = total;
+        best_entries.assign(k, 0);
+        best_entries[0] = first;
+        best_entries[k - 1] = layer_entries[p];
+        for (size_t i = k - 1; i >= 2; --i) {
+          best_entries[i - 1] = back[i][best_entries[i]];
+        }
+      }
+    }
+  }
+
+  tour.reserve(graph_.VertexCount() + 1);
+  for (size_t i = 0; i < k; ++i) {
+    const std::vector<int>& cycle = cycles[sequence[i]];
+    for (size_t j = 0; j < cycle.size(); ++j) {
+      tour.push_back(cycle[(best_entries[i] + j) % cycle.size()]);
+    }
+  }
+  tour.push_back(tour.front());
+  return tour;
+}
+
+}  // namespace lr4
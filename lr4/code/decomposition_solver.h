@@ -0,0 +1,50 @@
+#ifndef LR4_DECOMPOSITION_SOLVER_H
+#define LR4_DECOMPOSITION_SOLVER_H
+
+#include <cstddef>
+#include <vector>
+
+#include "ant_colony_solver.h"
+#include "graph.h"
+#include "local_search.h"
+
+namespace lr4 {
+
+struct DecompositionParameters {
+  size_t cluster_size = 64;                 // target number of vertices per cluster
+  AntColonyParameters colony{24, 40};       // colony used per cluster and for cluster order
+  LocalSearchParameters local_search;       // polishing of the stitched tour
+  size_t entry_candidates = 4;              // entry points of the first cluster tried when stitching
+};
+
+// Divide-and-conquer solver for large graphs: vertices are grouped into
+// clusters grown along the cheapest edges, every cluster gets its own colony,
+// the clusters are ordered by a colony over the cluster graph and the
+// resulting sub-tours are cut and joined where it is cheapest.
+class DecompositionSolver {
+ public:
+  explicit DecompositionSolver(const Graph& graph);
+
+  TourResult Run(const DecompositionParameters& params, size_t thread_count) const;
+
+ private:
+  std::vector<std::vector<size_t>> Partition(size_t cluster_size) const;
+
+  std::vector<int> SolveCluster(const std::vector<size_t>& cluster,
+                                const DecompositionParameters& params,
+                                unsigned int seed) const;
+
+  std::vector<size_t> OrderClusters(const std::vector<std::vector<int>>& cycles,
+                                    const DecompositionParameters& params,
+                                    size_t thread_count) const;
+
+  std::vector<int> Stitch(const std::vector<std::vector<int>>& cycles,
+                          const std::vector<size_t>& order,
+                          size_t entry_candidates) const;
+
+  const Graph& graph_;
+};
+
+}  // namespace lr4
+
+#endif  // LR4_DECOMPOSITION_SOLVER_H
@@ -0,0 +1,215 @@
+#include "genetic_solver.h"
+
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+#include <utility>
+
+#include "parallel.h"
+
+namespace lr4 {
+
+GeneticSolver::GeneticSolver(const Graph& graph) : graph_(graph) {}
+
+TourResult GeneticSolver::Run(const GeneticParameters& params, size_t thread_count,
+                              SearchControl* control) const {
+  TourResult result;
+  const size_t n = graph_.VertexCount();
+  if (thread_count == 0 || n == 0) {
+    return result;
+  }
+  auto start = std::chrono::steady_clock::now();
+  const size_t population_size = std::max<size_t>(2, params.population);
+  const size_t elite = std::min(params.elite, population_size - 1);
+  const size_t tournament = std::max<size_t>(1, params.tournament);
+
+  // Generation g is read from `population` while g + 1 is written into `next`;
+  // both are allocated once and swapped.
+  std::vector<Individual> population(population_size);
+  std::vector<Individual> next(population_size);
+  for (Individual& individual : next) {
+    individual.cycle.resize(n);
+  }
+  std::vector<int> greedy = GreedyTour(graph_);
+  greedy.pop_back();
+  ParallelFor(population_size, thread_count, [&](size_t index, size_t) {
+    Individual& individual = population[index];
+    if (index == 0) {
+      individual.cycle = greedy;
+    } else {
+      std::mt19937 rng(params.seed + static_cast<unsigned int>(index * 9973));
+      individual.cycle.resize(n);
+      std::iota(individual.cycle.begin(), individual.cycle.end(), 0);
+      std::shuffle(individual.cycle.begin(), individual.cycle.end(), rng);
+    }
+    individual.cost = CycleCost(graph_, individual.cycle);
+  });
+
+  std::vector<Arena> arenas(std::min(thread_count, population_size));
+  for (Arena& arena : arenas) {
+    arena.used.resize(n);
+    arena.successors.resize(2 * n);
+  }
+  std::vector<size_t> ranking(population_size);
+  std::vector<TracePoint> trace;
+  for (size_t generation = 0; generation < params.generations; ++generation) {
+    if (control != nullptr && control->Expired()) {
+      break;
+    }
+    std::iota(ranking.begin(), ranking.end(), 0);
+    std::sort(ranking.begin(), ranking.end(), [&](size_t a, size_t b) {
+      return population[a].cost < population[b].cost;
+    });
+    const TourCost& leader_cost = population[ranking.front()].cost;
+    RecordTrace(start, leader_cost.missing == 0 ? leader_cost.finite : Graph::kInfinity, &trace);
+    if (control != nullptr) {
+      Individual& leader = population[ranking.front()];
+      double leader_length = leader.cost.missing == 0 ? leader.cost.finite : Graph::kInfinity;
+      if (leader_length < control->BestLength()) {
+        std::vector<int> tour = leader.cycle;
+        tour.push_back(tour.front());
+        control->Offer(tour, leader_length);
+      }
+      std::vector<int> incumbent;
+      if (control->TakeIfBetter(leader_length, &incumbent)) {
+        Individual& worst = population[ranking.back()];
+        worst.cycle.assign(incumbent.begin(), incumbent.end() - 1);
+        worst.cost = CycleCost(graph_, worst.cycle);
+        std::rotate(ranking.begin(), ranking.end() - 1, ranking.end());
+      }
+    }
+    for (size_t e = 0; e < elite; ++e) {
+      next[e].cycle = population[ranking[e]].cycle;
+      next[e].cost = population[ranking[e]].cost;
+    }
+    // Offspring seeds depend only on (generation, slot), so the result does
+    // not depend on how slots are spread over the workers.
+    ParallelFor(population_size - elite, thread_count, [&](size_t index, size_t worker) {
+      std::mt19937 rng(params.seed + static_cast<unsigned int>(generation * 7919 + index * 9973));
+      std::uniform_int_distribution<size_t> pick(0, population_size - 1);
+      auto select = [&]() -> const Individual& {
+        size_t best = pick(rng);
+        for (size_t round = 1; round < tournament; ++round) {
+          size_t candidate = pick(rng);
+          if (population[candidate].cost < population[best].cost) {
+            best = candidate;
+          }
+        }
+        return population[best];
+      };
+      const Individual& first = select();
+      const Individual& second = select();
+      Individual& child = next[elite + index];
+      if (params.crossover == Crossover::kEdgeRecombination) {
+        EdgeRecombination(first, second, rng, &arenas[worker], &child);
+      } else {
+        OrderCrossover(first, second, rng, &arenas[worker], &child);
+      }
+      if (std::bernoulli_distribution(params.mutation_rate)(rng)) {
+        Mutate(rng, &child);
+      }
+      child.cost = CycleCost(graph_, child.cycle);
+    });
+    std::swap(population, next);
+  }
+
+  const Individual* best = &population.front();
+  for (const Individual& individual : population) {
+    if (individual.cost < best->cost) {
+      best = &individual;
+    }
+  }
+  std::vector<int> tour = best->cycle;
+  tour.push_back(tour.front());
+  result = SingleTourResult(graph_, tour);
+  RecordTrace(start, result.best_length, &trace);
+  result.trace = std::move(trace);
+  auto end = std::chrono::steady_clock::now();
+  result.elapsed_ms = std::chrono::duration<double, std::milli>(end - start).count();
+  return result;
+}
+
+void GeneticSolver::OrderCrossover(const Individual& first, const Individual& second,
+                                   std::mt19937& rng, Arena* arena, Individual* child) const {
+  const size_t n = first.cycle.size();
+  std::uniform_int_distribution<size_t> cut(0, n - 1);
+  size_t left = cut(rng);
+  size_t right = cut(rng);
+  if (left > right) {
+    std::swap(left, right);
+  }
+  std::fill(arena->used.begin(), arena->used.end(), 0);
+  for (size_t i = left; i <= right; ++i) {
+    child->cycle[i] = first.cycle[i];
+    arena->used[static_cast<size_t>(first.cycle[i])] = 1;
+  }
+  // The remaining slots are filled after the slice, in the cyclic order of
+  // the second parent, which keeps the direction of its edges.
+  size_t slot = (right + 1) % n;
+  for (size_t offset = 0; offset < n; ++offset) {
+    int vertex = second.cycle[(right + 1 + offset) % n];
+    if (arena->used[static_cast<size_t>(vertex)]) {
+      continue;
+    }
+    child->cycle[slot] = vertex;
+    slot = (slot + 1) % n;
+  }
+}
+
+void GeneticSolver::EdgeRecombination(const Individual& first, const Individual& second,
+                                      std::mt19937& rng, Arena* arena, Individual* child) const {
+  const size_t n = first.cycle.size();
+  for (size_t i = 0; i < n; ++i) {
+    arena->successors[2 * static_cast<size_t>(first.cycle[i])] = first.cycle[(i + 1) % n];
+    arena->successors[2 * static_cast<size_t>(second.cycle[i]) + 1] = second.cycle[(i + 1) % n];
+  }
+  std::fill(arena->used.begin(), arena->used.end(), 0);
+  size_t start = std::uniform_int_distribution<size_t>(0, n - 1)(rng);
+  int current = first.cycle[start];
+  arena->used[static_cast<size_t>(current)] = 1;
+  child->cycle[0] = current;
+  // Fallback when both parental successors are taken: the next unused vertex
+  // in the order of the first parent.
+  size_t scan = start;
+  for (size_t slot = 1; slot < n; ++slot) {
+    int a = arena->successors[2 * static_cast<size_t>(current)];
+    int b = arena->successors[2 * static_cast<size_t>(current) + 1];
+    bool a_free = !arena->used[static_cast<size_t>(a)];
+    bool b_free = !arena->used[static_cast<size_t>(b)];
+    int chosen = -1;
+    if (a_free && b_free) {
+      double weight_a = graph_.Weight(static_cast<size_t>(current), static_cast<size_t>(a));
+      double weight_b = graph_.Weight(static_cast<size_t>(current), static_cast<size_t>(b));
+      chosen = weight_b < weight_a ? b : a;
+    } else if (a_free) {
+      chosen = a;
+    } else if (b_free) {
+      chosen = b;
+    } else {
+      while (arena->used[static_cast<size_t>(first.cycle[scan])]) {
+        scan = (scan + 1) % n;
+      }
+      chosen = first.cycle[scan];
+    }
+    arena->used[static_cast<size_t>(chosen)] = 1;
+    child->cycle[slot] = chosen;
+    current = chosen;
+  }
+}
+
+void GeneticSolver::Mutate(std::mt19937& rng, Individual* child) {
+  const size_t n = child->cycle.size();
+  if (n < 4) {
+    return;
+  }
+  std::uniform_int_distribution<size_t> position(0, n - 1);
+  size_t i = position(rng);
+  size_t j = position(rng);
+  if (i > j) {
+    std::swap(i, j);
+  }
+  std::reverse(child->cycle.begin() + static_cast<long>(i),
+               child->cycle.begin() + static_cast<long>(j + 1));
+}
+
+}  // namespace lr4
@@ -0,0 +1,68 @@
+#ifndef LR4_GENETIC_SOLVER_H
+#define LR4_GENETIC_SOLVER_H
+
+#include <cstddef>
+#include <random>
+#include <vector>
+
+#include "ant_colony_solver.h"
+#include "graph.h"
+#include "local_search.h"
+#include "search_control.h"
+
+namespace lr4 {
+
+enum class Crossover {
+  kOrder,               // OX: a slice of one parent, the rest in the order of the other
+  kEdgeRecombination,   // offspring assembled from the union of the parents' edges
+};
+
+struct GeneticParameters {
+  size_t population = 64;
+  size_t generations = 200;
+  size_t elite = 2;                          // best individuals copied unchanged
+  size_t tournament = 3;                     // tournament size for parent selection
+  double mutation_rate = 0.2;                // probability of a 2-opt mutation per offspring
+  Crossover crossover = Crossover::kOrder;
+  unsigned int seed = 42;                    // random seed
+};
+
+// Generational genetic algorithm over tours. Offspring of a generation are
+// built, mutated and evaluated in parallel; every worker has its own scratch
+// arena and writes into a preallocated slot, so memory stays
+// O(population * n) and nothing is allocated once the run is warmed up.
+class GeneticSolver {
+ public:
+  explicit GeneticSolver(const Graph& graph);
+
+  // With a `control`, the run stops at the deadline, publishes the best
+  // individual of every generation and lets a shorter incumbent replace the
+  // worst individual.
+  TourResult Run(const GeneticParameters& params, size_t thread_count,
+                 SearchControl* control = nullptr) const;
+
+ private:
+  struct Individual {
+    std::vector<int> cycle;   // open cycle, without the repeated start vertex
+    TourCost cost;
+  };
+
+  struct Arena {
+    std::vector<char> used;
+    std::vector<int> successors;   // two candidate successors per vertex
+  };
+
+  void OrderCrossover(const Individual& first, const Individual& second, std::mt19937& rng,
+                      Arena* arena, Individual* child) const;
+
+  void EdgeRecombination(const Individual& first, const Individual& second, std::mt19937& rng,
+                         Arena* arena, Individual* child) const;
+
+  static void Mutate(std::mt19937& rng, Individual* child);
+
+  const Graph& graph_;
+};
+
+}  // namespace lr4
+
+#endif  // LR4_GENETIC_SOLVER_H
@@ -1,7 +1,15 @@
 #include "graph.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <algorithm>
 #include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <optional>
 #include <regex>
@@ -10,6 +18,8 @@
 #include <string_view>
 #include <unordered_set>
 
+#include "parallel.h"
+
 namespace lr4 {
 namespace {
 
@@ -102,8 +112,115 @@ RawEdge ParseEdgeLine(const std::string& line) {
   return edge;
 }
 
+// TSPLIB distance functions. They truncate through int like the reference
+// implementation, which also keeps the row loops below vectorisable.
+double EuclideanDistance(double squared) {
+  return static_cast<double>(static_cast<int>(std::sqrt(squared) + 0.5));
+}
+
+double CeilEuclideanDistance(double squared) {
+  const double distance = std::sqrt(squared);
+  const double truncated = static_cast<double>(static_cast<int>(distance));
+  return truncated + static_cast<double>(truncated < distance);
+}
+
+double AttDistance(double squared) {
+  const double distance = std::sqrt(squared / 10.0);
+  const double rounded = static_cast<double>(static_cast<int>(distance + 0.5));
+  return rounded + static_cast<double>(rounded < distance);
+}
+
+double GeographicDistance(double latitude_a, double longitude_a,
+                          double latitude_b, double longitude_b) {
+  constexpr double kEarthRadius = 6378.388;
+  const double q1 = std::cos(longitude_a - longitude_b);
+  const double q2 = std::cos(latitude_a - latitude_b);
+  const double q3 = std::cos(latitude_a + latitude_b);
+  const double cosine = std::min(1.0, 0.5 * ((1.0 + q1) * q2 - (1.0 - q1) * q3));
+  return static_cast<double>(static_cast<int>(kEarthRadius * std::acos(cosine) + 1.0));
+}
+
+// DDD.MM (degrees and minutes) to radians, with the value of pi TSPLIB uses.
+double GeographicRadians(double value) {
+  constexpr double kPi = 3.141592;
+  const double degrees = std::trunc(value);
+  return kPi * (degrees + 5.0 * (value - degrees) / 3.0) / 180.0;
+}
+
+template <typename Distance>
+void FillPlanarRow(const std::vector<double>& x, const std::vector<double>& y, size_t from,
+                   Distance distance, double* out) {
+  const size_t n = x.size();
+  const double* xs = x.data();
+  const double* ys = y.data();
+  const double from_x = xs[from];
+  const double from_y = ys[from];
+  for (size_t to = 0; to < n; ++to) {
+    const double dx = from_x - xs[to];
+    const double dy = from_y - ys[to];
+    out[to] = distance(dx * dx + dy * dy);
+  }
+}
+
+constexpr char kBinaryMagic[8] = {'L', 'R', '4', 'G', 'R', 'A', 'P', 'H'};
+constexpr uint32_t kBinaryVersion = 1;
+
+struct BinaryHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t metric;
+  uint64_t vertices;
+  uint64_t label_bytes;   // labels, each terminated by '\0', padded to 8 bytes
+  uint32_t symmetric;
+  uint32_t reserved;
+};
+
+uint64_t PaddedLabelBytes(uint64_t label_bytes) {
+  return (label_bytes + 7) / 8 * 8;
+}
+
+std::optional<Graph::Metric> ParseTsplibMetric(const std::string& type) {
+  if (type == "EUC_2D") {
+    return Graph::Metric::kEuclidean;
+  }
+  if (type == "CEIL_2D") {
+    return Graph::Metric::kCeilEuclidean;
+  }
+  if (type == "GEO") {
+    return Graph::Metric::kGeographic;
+  }
+  if (type == "ATT") {
+    return Graph::Metric::kAtt;
+  }
+  if (type == "EXPLICIT") {
+    return Graph::Metric::kExplicit;
+  }
+  return std::nullopt;
+}
+
 }  // namespace
 
+Graph::Graph(const Graph& other)
+    : index_to_label_(other.index_to_label_),
+      label_to_index_(other.label_to_index_),
+      storage_(other.storage_),
+      weights_(other.OwnsWeights() ? storage_.data() : other.weights_),
+      symmetric_(other.symmetric_),
+      metric_(other.metric_),
+      x_(other.x_),
+      y_(other.y_),
+      neighbours_(other.neighbours_),
+      neighbour_count_(other.neighbour_count_),
+      mapping_(other.mapping_) {}
+
+Graph& Graph::operator=(const Graph& other) {
+  if (this != &other) {
+    Graph copy(other);
+    *this = std::move(copy);
+  }
+  return *this;
+}
+
 Graph Graph::FromGraphvizFile(const std::string& path) {
   std::ifstream input(path);
   if (!input) {
@@ -131,14 +248,11 @@ Graph Graph::FromGraphviz(std::istream& input) {
   std::vector<std::string> sorted_labels(labels.begin(), labels.end());
   std::sort(sorted_labels.begin(), sorted_labels.end());
   Graph graph;
-  graph.index_to_label_ = sorted_labels;
-  for (size_t i = 0; i < sorted_labels.size(); ++i) {
-    graph.label_to_index_.emplace(sorted_labels[i], i);
-  }
-  const size_t n = sorted_labels.size();
-  graph.adjacency_.assign(n, std::vector<double>(n, kInfinity));
+  graph.SetLabels(std::move(sorted_labels));
+  const size_t n = graph.VertexCount();
+  std::vector<double> weights(n * n, kInfinity);
   for (size_t i = 0; i < n; ++i) {
-    graph.adjacency_[i][i] = 0.0;
+    weights[i * n + i] = 0.0;
   }
   for (const RawEdge& edge : edges) {
     auto from_it = graph.label_to_index_.find(edge.from);
@@ -146,14 +260,454 @@ Graph Graph::FromGraphviz(std::istream& input) {
     if (from_it == graph.label_to_index_.end() || to_it == graph.label_to_index_.end()) {
       continue;
     }
-    graph.adjacency_[from_it->second][to_it->second] = edge.weight;
+    weights[from_it->second * n + to_it->second] = edge.weight;
     if (edge.bidirectional) {
-      graph.adjacency_[to_it->second][from_it->second] = edge.weight;
+      weights[to_it->second * n + from_it->second] = edge.weight;
+    }
+  }
+  graph.AdoptWeights(std::move(weights));
+  graph.UpdateSymmetry();
+  return graph;
+}
+
+Graph Graph::FromAdjacency(std::vector<std::string> labels,
+                           std::vector<std::vector<double>> adjacency) {
+  if (adjacency.size() != labels.size()) {
+    throw std::invalid_argument("Adjacency matrix does not match label count");
+  }
+  for (const auto& row : adjacency) {
+    if (row.size() != labels.size()) {
+      throw std::invalid_argument("Adjacency matrix must be square");
+    }
+  }
+  const size_t n = labels.size();
+  std::vector<double> weights;
+  weights.reserve(n * n);
+  for (const auto& row : adjacency) {
+    weights.insert(weights.end(), row.begin(), row.end());
+  }
+  Graph graph;
+  graph.SetLabels(std::move(labels));
+  graph.AdoptWeights(std::move(weights));
+  graph.UpdateSymmetry();
+  return graph;
+}
+
+Graph Graph::FromWeights(std::vector<double> weights, size_t n, std::vector<std::string> labels) {
+  if (weights.size() != n * n) {
+    throw std::invalid_argument("Weight buffer must hold n * n entries");
+  }
+  Graph graph = FromMatrix(weights.data(), n, std::move(labels));
+  graph.AdoptWeights(std::move(weights));
+  graph.UpdateSymmetry();
+  return graph;
+}
+
+Graph Graph::FromMatrix(const double* weights, size_t n, std::vector<std::string> labels) {
+  if (labels.empty()) {
+    labels.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+      labels.push_back(std::to_string(i));
+    }
+  }
+  if (labels.size() != n) {
+    throw std::invalid_argument("Matrix size does not match label count");
+  }
+  if (weights == nullptr && n != 0) {
+    throw std::invalid_argument("Matrix buffer is null");
+  }
+  Graph graph;
+  graph.SetLabels(std::move(labels));
+  graph.weights_ = weights;
+  graph.symmetric_.reset();
+  return graph;
+}
+
+Graph Graph::FromCoordinates(Metric metric, std::vector<double> x, std::vector<double> y,
+                             std::vector<std::string> labels) {
+  if (metric == Metric::kExplicit) {
+    throw std::invalid_argument("Coordinates need a metric");
+  }
+  if (x.size() != y.size()) {
+    throw std::invalid_argument("Coordinate arrays differ in size");
+  }
+  const size_t n = x.size();
+  if (labels.empty()) {
+    labels.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+      labels.push_back(std::to_string(i + 1));
+    }
+  }
+  if (labels.size() != n) {
+    throw std::invalid_argument("Coordinate count does not match label count");
+  }
+  for (size_t i = 0; i < n; ++i) {
+    if (!std::isfinite(x[i]) || !std::isfinite(y[i])) {
+      throw std::invalid_argument("Coordinates must be finite");
+    }
+    if (metric == Metric::kGeographic) {
+      x[i] = GeographicRadians(x[i]);
+      y[i] = GeographicRadians(y[i]);
+    }
+  }
+  Graph graph;
+  graph.SetLabels(std::move(labels));
+  graph.metric_ = metric;
+  graph.x_ = std::move(x);
+  graph.y_ = std::move(y);
+  return graph;
+}
+
+Graph Graph::FromTsplibFile(const std::string& path) {
+  std::ifstream input(path);
+  if (!input) {
+    throw std::runtime_error("Unable to open graph file: " + path);
+  }
+  return FromTsplib(input);
+}
+
+Graph Graph::FromTsplib(std::istream& input) {
+  size_t dimension = 0;
+  std::string weight_type;
+  std::string weight_format;
+  std::vector<std::string> labels;
+  std::vector<double> x;
+  std::vector<double> y;
+  std::vector<double> matrix;
+  auto need_dimension = [&dimension]() {
+    if (dimension == 0) {
+      throw std::runtime_error("TSPLIB: DIMENSION must precede the data sections");
+    }
+  };
+  std::string line;
+  while (std::getline(input, line)) {
+    std::string text = Trim(line);
+    if (text.empty()) {
+      continue;
     }
+    if (text == "EOF") {
+      break;
+    }
+    std::string key = text;
+    std::string value;
+    size_t colon = text.find(':');
+    if (colon != std::string::npos) {
+      key = Trim(std::string_view(text).substr(0, colon));
+      value = Trim(std::string_view(text).substr(colon + 1));
+    }
+    if (key == "TYPE") {
+      if (value != "TSP" && value != "ATSP") {
+        throw std::runtime_error("TSPLIB: unsupported problem type " + value);
+      }
+    } else if (key == "DIMENSION") {
+      long long parsed = std::stoll(value);
+      if (parsed <= 0) {
+        throw std::runtime_error("TSPLIB: DIMENSION must be positive");
+      }
+      dimension = static_cast<size_t>(parsed);
+    } else if (key == "EDGE_WEIGHT_TYPE") {
+      weight_type = value;
+    } else if (key == "EDGE_WEIGHT_FORMAT") {
+      weight_format = value;
+    } else if (key == "NODE_COORD_SECTION") {
+      need_dimension();
+      labels.resize(dimension);
+      x.resize(dimension);
+      y.resize(dimension);
+      for (size_t i = 0; i < dimension; ++i) {
+        if (!(input >> labels[i] >> x[i] >> y[i])) {
+          throw std::runtime_error("TSPLIB: truncated NODE_COORD_SECTION");
+        }
+      }
+    } else if (key == "EDGE_WEIGHT_SECTION") {
+      need_dimension();
+      matrix.resize(dimension * dimension);
+      for (double& weight : matrix) {
+        if (!(input >> weight)) {
+          throw std::runtime_error("TSPLIB: truncated EDGE_WEIGHT_SECTION");
+        }
+      }
+    } else if (key == "DISPLAY_DATA_SECTION") {
+      need_dimension();
+      std::string skipped;
+      for (size_t i = 0; i < 3 * dimension; ++i) {
+        input >> skipped;
+      }
+    } else if (key.size() > 8 && key.compare(key.size() - 8, 8, "_SECTION") == 0) {
+      throw std::runtime_error("TSPLIB: unsupported section " + key);
+    }
+  }
+
+  std::optional<Metric> metric = ParseTsplibMetric(weight_type);
+  if (!metric) {
+    throw std::runtime_error("TSPLIB: unsupported EDGE_WEIGHT_TYPE " + weight_type);
+  }
+  if (*metric != Metric::kExplicit) {
+    if (x.size() != dimension || dimension == 0) {
+      throw std::runtime_error("TSPLIB: NODE_COORD_SECTION is missing");
+    }
+    return FromCoordinates(*metric, std::move(x), std::move(y), std::move(labels));
+  }
+  if (weight_format != "FULL_MATRIX") {
+    throw std::runtime_error("TSPLIB: unsupported EDGE_WEIGHT_FORMAT " + weight_format);
+  }
+  if (matrix.size() != dimension * dimension || dimension == 0) {
+    throw std::runtime_error("TSPLIB: EDGE_WEIGHT_SECTION is missing");
+  }
+  // ATSP files put a large sentinel on the diagonal; self-loops are never
+  // used, so they get the same zero as in DOT input.
+  for (size_t i = 0; i < dimension; ++i) {
+    matrix[i * dimension + i] = 0.0;
+    labels.push_back(std::to_string(i + 1));
+  }
+  Graph graph;
+  graph.SetLabels(std::move(labels));
+  graph.AdoptWeights(std::move(matrix));
+  graph.UpdateSymmetry();
+  return graph;
+}
+
+Graph Graph::FromBinaryFile(const std::string& path) {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("Unable to open graph file: " + path);
+  }
+  struct stat info;
+  if (::fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(BinaryHeader))) {
+    ::close(fd);
+    throw std::runtime_error("Not a binary graph file: " + path);
+  }
+  const size_t file_size = static_cast<size_t>(info.st_size);
+  void* address = ::mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (address == MAP_FAILED) {
+    throw std::runtime_error("Unable to map graph file: " + path);
+  }
+  std::shared_ptr<const void> mapping(address, [file_size](const void* region) {
+    ::munmap(const_cast<void*>(region), file_size);
+  });
+  const char* bytes = static_cast<const char*>(address);
+  BinaryHeader header;
+  std::memcpy(&header, bytes, sizeof(header));
+  if (std::memcmp(header.magic, kBinaryMagic, sizeof(kBinaryMagic)) != 0 ||
+      header.version != kBinaryVersion ||
+      header.metric > static_cast<uint32_t>(Metric::kAtt)) {
+    throw std::runtime_error("Not a binary graph file: " + path);
+  }
+  const uint64_t n = header.vertices;
+  const Metric metric = static_cast<Metric>(header.metric);
+  const uint64_t max_values = file_size / sizeof(double);
+  const bool fits = metric == Metric::kExplicit ? n == 0 || n <= max_values / n
+                                                : n <= max_values / 2;
+  if (!fits || header.label_bytes > file_size) {
+    throw std::runtime_error("Truncated binary graph file: " + path);
+  }
+  const uint64_t values = metric == Metric::kExplicit ? n * n : 2 * n;
+  const uint64_t data_offset = sizeof(BinaryHeader) + PaddedLabelBytes(header.label_bytes);
+  if (data_offset + values * sizeof(double) != file_size) {
+    throw std::runtime_error("Truncated binary graph file: " + path);
+  }
+  std::vector<std::string> labels;
+  labels.reserve(n);
+  const char* label = bytes + sizeof(BinaryHeader);
+  const char* labels_end = label + header.label_bytes;
+  while (label < labels_end && labels.size() < n) {
+    size_t length = strnlen(label, static_cast<size_t>(labels_end - label));
+    labels.emplace_back(label, length);
+    label += length + 1;
+  }
+  if (labels.size() != n) {
+    throw std::runtime_error("Truncated binary graph file: " + path);
+  }
+  const double* data = reinterpret_cast<const double*>(bytes + data_offset);
+  Graph graph;
+  graph.SetLabels(std::move(labels));
+  graph.metric_ = metric;
+  graph.symmetric_ = header.symmetric != 0;
+  if (metric == Metric::kExplicit) {
+    graph.weights_ = data;
+    graph.mapping_ = std::move(mapping);
+  } else {
+    graph.x_.assign(data, data + n);
+    graph.y_.assign(data + n, data + 2 * n);
   }
   return graph;
 }
 
+void Graph::SaveBinary(const std::string& path) const {
+  std::ofstream output(path, std::ios::binary | std::ios::trunc);
+  if (!output) {
+    throw std::runtime_error("Unable to write graph file: " + path);
+  }
+  const size_t n = VertexCount();
+  BinaryHeader header{};
+  std::memcpy(header.magic, kBinaryMagic, sizeof(kBinaryMagic));
+  header.version = kBinaryVersion;
+  header.metric = static_cast<uint32_t>(metric_);
+  header.vertices = n;
+  header.symmetric = IsSymmetric() ? 1 : 0;
+  for (const std::string& label : index_to_label_) {
+    header.label_bytes += label.size() + 1;
+  }
+  output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  for (const std::string& label : index_to_label_) {
+    output.write(label.c_str(), static_cast<std::streamsize>(label.size() + 1));
+  }
+  const char padding[8] = {};
+  output.write(padding, static_cast<std::streamsize>(PaddedLabelBytes(header.label_bytes) -
+                                                     header.label_bytes));
+  if (metric_ == Metric::kExplicit) {
+    output.write(reinterpret_cast<const char*>(weights_),
+                 static_cast<std::streamsize>(n * n * sizeof(double)));
+  } else {
+    output.write(reinterpret_cast<const char*>(x_.data()),
+                 static_cast<std::streamsize>(n * sizeof(double)));
+    output.write(reinterpret_cast<const char*>(y_.data()),
+                 static_cast<std::streamsize>(n * sizeof(double)));
+  }
+  if (!output) {
+    throw std::runtime_error("Unable to write graph file: " + path);
+  }
+}
+
+void Graph::FillRow(size_t from, double* out) const {
+  const size_t n = VertexCount();
+  switch (metric_) {
+    case Metric::kExplicit:
+      std::copy(weights_ + from * n, weights_ + (from + 1) * n, out);
+      return;
+    case Metric::kEuclidean:
+      FillPlanarRow(x_, y_, from, [](double squared) { return EuclideanDistance(squared); }, out);
+      break;
+    case Metric::kCeilEuclidean:
+      FillPlanarRow(x_, y_, from, [](double squared) { return CeilEuclideanDistance(squared); },
+                    out);
+      break;
+    case Metric::kAtt:
+      FillPlanarRow(x_, y_, from, [](double squared) { return AttDistance(squared); }, out);
+      break;
+    case Metric::kGeographic:
+      for (size_t to = 0; to < n; ++to) {
+        out[to] = GeographicDistance(x_[from], y_[from], x_[to], y_[to]);
+      }
+      break;
+  }
+  out[from] = 0.0;
+}
+
+double Graph::MetricWeight(size_t from, size_t to) const {
+  if (from == to) {
+    return 0.0;
+  }
+  if (metric_ == Metric::kGeographic) {
+    return GeographicDistance(x_[from], y_[from], x_[to], y_[to]);
+  }
+  const double dx = x_[from] - x_[to];
+  const double dy = y_[from] - y_[to];
+  const double squared = dx * dx + dy * dy;
+  if (metric_ == Metric::kCeilEuclidean) {
+    return CeilEuclideanDistance(squared);
+  }
+  if (metric_ == Metric::kAtt) {
+    return AttDistance(squared);
+  }
+  return EuclideanDistance(squared);
+}
+
+void Graph::BuildNeighbours(size_t count, size_t thread_count) {
+  const size_t n = VertexCount();
+  neighbour_count_ = n == 0 ? 0 : std::min(count, n - 1);
+  neighbours_.assign(n * neighbour_count_, 0);
+  if (neighbour_count_ == 0) {
+    return;
+  }
+  const size_t workers = std::max<size_t>(1, std::min(thread_count, n));
+  std::vector<std::vector<double>> rows(workers, std::vector<double>(n));
+  std::vector<std::vector<int>> orders(workers);
+  ParallelFor(n, workers, [&](size_t from, size_t worker) {
+    std::vector<double>& row = rows[worker];
+    std::vector<int>& order = orders[worker];
+    FillRow(from, row.data());
+    order.clear();
+    for (size_t to = 0; to < n; ++to) {
+      if (to != from) {
+        order.push_back(static_cast<int>(to));
+      }
+    }
+    auto closer = [&row](int a, int b) {
+      double weight_a = row[static_cast<size_t>(a)];
+      double weight_b = row[static_cast<size_t>(b)];
+      return weight_a < weight_b || (weight_a == weight_b && a < b);
+    };
+    auto middle = order.begin() + static_cast<long>(neighbour_count_);
+    std::partial_sort(order.begin(), middle, order.end(), closer);
+    std::copy(order.begin(), middle, neighbours_.begin() + static_cast<long>(from * neighbour_count_));
+  });
+}
+
+void Graph::SetLabels(std::vector<std::string> labels) {
+  index_to_label_ = std::move(labels);
+  label_to_index_.clear();
+  label_to_index_.reserve(index_to_label_.size());
+  for (size_t i = 0; i < index_to_label_.size(); ++i) {
+    if (!label_to_index_.emplace(index_to_label_[i], i).second) {
+      throw std::invalid_argument("Duplicate vertex label: " + index_to_label_[i]);
+    }
+  }
+}
+
+void Graph::AdoptWeights(std::vector<double> weights) {
+  storage_ = std::move(weights);
+  weights_ = storage_.data();
+}
+
+bool Graph::ComputeSymmetry() const {
+  const size_t n = VertexCount();
+  if (metric_ != Metric::kExplicit) {
+    return true;
+  }
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = i + 1; j < n; ++j) {
+      if (Weight(i, j) != Weight(j, i)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+Graph Graph::Subgraph(const std::vector<size_t>& vertices) const {
+  const size_t k = vertices.size();
+  std::vector<std::string> labels;
+  labels.reserve(k);
+  if (metric_ != Metric::kExplicit) {
+    Graph graph;
+    graph.metric_ = metric_;
+    graph.x_.reserve(k);
+    graph.y_.reserve(k);
+    for (size_t vertex : vertices) {
+      labels.push_back(Label(vertex));
+      graph.x_.push_back(x_[vertex]);
+      graph.y_.push_back(y_[vertex]);
+    }
+    graph.SetLabels(std::move(labels));
+    return graph;
+  }
+  std::vector<double> weights(k * k);
+  for (size_t i = 0; i < k; ++i) {
+    labels.push_back(Label(vertices[i]));
+    const double* row = Row(vertices[i]);
+    for (size_t j = 0; j < k; ++j) {
+      weights[i * k + j] = row[vertices[j]];
+    }
+  }
+  Graph graph;
+  graph.SetLabels(std::move(labels));
+  graph.AdoptWeights(std::move(weights));
+  graph.UpdateSymmetry();
+  return graph;
+}
+
 std::vector<int> Graph::CanonicalizeTour(const std::vector<int>& tour) const {
   if (tour.size() <= 1) {
     return tour;
@@ -192,6 +746,7 @@ std::vector<int> Graph::CanonicalizeTour(const std::vector<int>& tour) const {
     }
     return key;
   };
+  const bool symmetric = IsSymmetric();
   size_t best_shift = 0;
   bool best_reverse = false;
   std::string best_key = build_key(0, false);
@@ -202,6 +757,9 @@ std::vector<int> Graph::CanonicalizeTour(const std::vector<int>& tour) const {
       best_shift = shift;
       best_reverse = false;
     }
+    if (!symmetric) {
+      continue;
+    }
     std::string reverse_key = build_key(shift, true);
     if (reverse_key < best_key) {
       best_key = reverse_key;
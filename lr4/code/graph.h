@@ -4,6 +4,7 @@
 #include <cstddef>
 #include <istream>
 #include <limits>
+#include <memory>
 #include <optional>
 #include <string>
 #include <unordered_map>
@@ -12,17 +13,99 @@
 
 namespace lr4 {
 
+// Weighted digraph. Explicit graphs keep their weights in one contiguous
+// row-major n x n buffer that is either owned by the graph or, for views
+// created with FromMatrix, borrowed from the caller. Metric graphs keep only
+// vertex coordinates and compute weights on demand.
 class Graph {
  public:
+  // Distance functions of TSPLIB; kExplicit means a stored weight matrix.
+  enum class Metric {
+    kExplicit,
+    kEuclidean,       // EUC_2D: Euclidean distance rounded to the nearest integer
+    kCeilEuclidean,   // CEIL_2D: Euclidean distance rounded up
+    kGeographic,      // GEO: great-circle distance in km, coordinates are DDD.MM
+    kAtt,             // ATT: pseudo-Euclidean distance of the att48/att532 instances
+  };
+
+  Graph() = default;
+  Graph(const Graph& other);
+  Graph& operator=(const Graph& other);
+  Graph(Graph&&) = default;
+  Graph& operator=(Graph&&) = default;
+
   static Graph FromGraphvizFile(const std::string& path);
   static Graph FromGraphviz(std::istream& input);
+  // Builds a graph from a dense weight matrix; missing edges are kInfinity.
+  static Graph FromAdjacency(std::vector<std::string> labels,
+                             std::vector<std::vector<double>> adjacency);
+  // Takes over a row-major n x n matrix without copying it. Missing edges
+  // are kInfinity. Empty `labels` stand for "0", "1", ..., "n-1".
+  static Graph FromWeights(std::vector<double> weights, size_t n,
+                           std::vector<std::string> labels = {});
+  // Wraps a caller-owned row-major n x n matrix without copying it; the
+  // buffer must outlive the graph and every copy of it. The caller may change
+  // weights while the view lives, so its symmetry is not cached but checked
+  // in O(n^2) on every IsSymmetric(). Missing edges are kInfinity. Empty
+  // `labels` stand for "0", "1", ..., "n-1".
+  static Graph FromMatrix(const double* weights, size_t n,
+                          std::vector<std::string> labels = {});
+  // Metric graph over points (x[i], y[i]); memory is O(n). `metric` must not
+  // be kExplicit. Empty `labels` stand for "1", "2", ..., "n" as in TSPLIB.
+  static Graph FromCoordinates(Metric metric, std::vector<double> x, std::vector<double> y,
+                               std::vector<std::string> labels = {});
+  // TSPLIB TSP/ATSP files with EDGE_WEIGHT_TYPE EUC_2D, CEIL_2D, GEO, ATT or
+  // EXPLICIT in FULL_MATRIX format. Coordinate types give a metric graph.
+  static Graph FromTsplibFile(const std::string& path);
+  static Graph FromTsplib(std::istream& input);
+  // Native binary format: header, labels, then the n x n weights or the
+  // coordinates. Loading maps the file read-only and uses explicit weights
+  // in place; the mapping lives as long as the graph or any copy of it.
+  static Graph FromBinaryFile(const std::string& path);
+  void SaveBinary(const std::string& path) const;
 
   size_t VertexCount() const { return index_to_label_.size(); }
   double Weight(size_t from, size_t to) const {
-    return adjacency_[from][to];
+    if (metric_ == Metric::kExplicit) {
+      return weights_[from * VertexCount() + to];
+    }
+    return MetricWeight(from, to);
   }
+  // Weights of all edges leaving `from`, indexed by destination; nullptr for
+  // metric graphs, which have no stored rows.
+  const double* Row(size_t from) const {
+    return metric_ == Metric::kExplicit ? weights_ + from * VertexCount() : nullptr;
+  }
+  // Writes the weights of all edges leaving `from` into out[0..n). For metric
+  // graphs the whole row is computed in one pass over the coordinates.
+  void FillRow(size_t from, double* out) const;
+  // False for views created with FromMatrix or FromBinaryFile and for metric
+  // graphs.
+  bool OwnsWeights() const { return weights_ != nullptr && weights_ == storage_.data(); }
+  Metric GetMetric() const { return metric_; }
   const std::string& Label(size_t index) const { return index_to_label_[index]; }
 
+  // Caches the `count` nearest successors of every vertex, closest first,
+  // ties broken by index. Takes O(n^2) time and O(n * count) memory.
+  void BuildNeighbours(size_t count, size_t thread_count = 1);
+  // Size of the cached lists; 0 until BuildNeighbours is called.
+  size_t NeighbourCount() const { return neighbour_count_; }
+  const int* Neighbours(size_t from) const {
+    return neighbours_.data() + from * neighbour_count_;
+  }
+
+  // True when every edge has the same weight in both directions.
+  bool IsSymmetric() const { return symmetric_.has_value() ? *symmetric_ : ComputeSymmetry(); }
+  // False only for FromMatrix views, whose symmetry is checked on every call.
+  bool SymmetryCached() const { return symmetric_.has_value(); }
+
+  // Induced subgraph on `vertices`; vertex i of the result is vertices[i].
+  // Metric graphs give metric subgraphs. Neighbour lists are not carried over.
+  Graph Subgraph(const std::vector<size_t>& vertices) const;
+
+  // Rotates the tour to its lexicographically smallest label sequence; the
+  // reversed direction is only considered on symmetric graphs, where it
+  // describes the same tour.
   std::vector<int> CanonicalizeTour(const std::vector<int>& tour) const;
 
   static constexpr double kInfinity = std::numeric_limits<double>::infinity();
@@ -30,7 +113,22 @@ class Graph {
  private:
   std::vector<std::string> index_to_label_;
   std::unordered_map<std::string, size_t> label_to_index_;
-  std::vector<std::vector<double>> adjacency_;
+  std::vector<double> storage_;
+  const double* weights_ = nullptr;
+  std::optional<bool> symmetric_ = true;   // empty for FromMatrix views
+  Metric metric_ = Metric::kExplicit;
+  // Metric graphs: coordinates, for kGeographic latitude and longitude in radians.
+  std::vector<double> x_;
+  std::vector<double> y_;
+  std::vector<int> neighbours_;
+  size_t neighbour_count_ = 0;
+  std::shared_ptr<const void> mapping_;   // keeps a FromBinaryFile mapping alive
+
+  double MetricWeight(size_t from, size_t to) const;
+  void SetLabels(std::vector<std::string> labels);
+  void AdoptWeights(std::vector<double> weights);
+  bool ComputeSymmetry() const;
+  void UpdateSymmetry() { symmetric_ = ComputeSymmetry(); }
 };
 
 }  // namespace lr4
@@ -0,0 +1,135 @@
+#include "instance_generator.h"
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "parallel.h"
+
+namespace lr4 {
+namespace {
+
+// Points are drawn in blocks, so seeding a stream stays cheap next to the
+// work it serves.
+constexpr size_t kPointBlock = 1024;
+
+std::mt19937 StreamFor(unsigned int seed, size_t index) {
+  std::seed_seq sequence{seed, static_cast<unsigned int>(index),
+                         static_cast<unsigned int>(static_cast<unsigned long long>(index) >> 32)};
+  return std::mt19937(sequence);
+}
+
+void CheckVertexCount(size_t vertices) {
+  if (vertices < 2) {
+    throw std::invalid_argument("Graph must have at least two vertices");
+  }
+}
+
+template <typename Draw>
+Graph GeneratePoints(const GeneratorParameters& params, size_t thread_count, Draw draw) {
+  const size_t n = params.vertices;
+  std::vector<double> x(n);
+  std::vector<double> y(n);
+  const size_t blocks = (n + kPointBlock - 1) / kPointBlock;
+  ParallelFor(blocks, thread_count, [&](size_t block, size_t) {
+    std::mt19937 rng = StreamFor(params.seed, block);
+    const size_t end = std::min(n, (block + 1) * kPointBlock);
+    for (size_t i = block * kPointBlock; i < end; ++i) {
+      draw(rng, &x[i], &y[i]);
+    }
+  });
+  return Graph::FromCoordinates(Graph::Metric::kEuclidean, std::move(x), std::move(y));
+}
+
+}  // namespace
+
+Graph GenerateSparseDigraph(const GeneratorParameters& params, size_t thread_count) {
+  const size_t n = params.vertices;
+  CheckVertexCount(n);
+  const size_t max_degree = std::min(std::max<size_t>(1, params.max_out_degree), n - 1);
+  std::vector<double> weights(n * n, Graph::kInfinity);
+  ParallelFor(n, thread_count, [&](size_t from, size_t) {
+    std::mt19937 rng = StreamFor(params.seed, from);
+    std::uniform_real_distribution<double> weight(1.0, 100.0);
+    std::uniform_int_distribution<size_t> vertex(0, n - 1);
+    double* row = weights.data() + from * n;
+    row[from] = 0.0;
+    row[(from + 1) % n] = weight(rng);
+    const size_t degree = std::uniform_int_distribution<size_t>(1, max_degree)(rng);
+    for (size_t out = 1; out < degree;) {
+      size_t to = vertex(rng);
+      if (to == from || row[to] != Graph::kInfinity) {
+        continue;
+      }
+      row[to] = weight(rng);
+      ++out;
+    }
+  });
+  std::vector<std::string> labels;
+  labels.reserve(n);
+  for (size_t i = 0; i < n; ++i) {
+    labels.push_back("v" + std::to_string(i));
+  }
+  return Graph::FromWeights(std::move(weights), n, std::move(labels));
+}
+
+Graph GenerateUniformEuclidean(const GeneratorParameters& params, size_t thread_count) {
+  CheckVertexCount(params.vertices);
+  const double side = params.side;
+  return GeneratePoints(params, thread_count, [side](std::mt19937& rng, double* x, double* y) {
+    std::uniform_real_distribution<double> coordinate(0.0, side);
+    *x = coordinate(rng);
+    *y = coordinate(rng);
+  });
+}
+
+Graph GenerateClusteredEuclidean(const GeneratorParameters& params, size_t thread_count) {
+  CheckVertexCount(params.vertices);
+  const size_t clusters = std::max<size_t>(1, params.clusters);
+  std::mt19937 centre_rng(params.seed);
+  std::uniform_real_distribution<double> coordinate(0.0, params.side);
+  std::vector<std::pair<double, double>> centres(clusters);
+  for (auto& centre : centres) {
+    centre.first = coordinate(centre_rng);
+    centre.second = coordinate(centre_rng);
+  }
+  const double spread = params.cluster_spread * params.side;
+  return GeneratePoints(params, thread_count, [&centres, spread, clusters](std::mt19937& rng,
+                                                                         double* x, double* y) {
+    const auto& centre = centres[std::uniform_int_distribution<size_t>(0, clusters - 1)(rng)];
+    std::normal_distribution<double> offset(0.0, spread);
+    *x = centre.first + offset(rng);
+    *y = centre.second + offset(rng);
+  });
+}
+
+Graph PerturbAsymmetric(const Graph& graph, double amount, unsigned int seed,
+                        size_t thread_count) {
+  if (!(amount >= 0.0 && amount < 1.0)) {
+    throw std::invalid_argument("Perturbation must be in [0, 1)");
+  }
+  const size_t n = graph.VertexCount();
+  std::vector<double> weights(n * n);
+  ParallelFor(n, thread_count, [&](size_t from, size_t) {
+    std::mt19937 rng = StreamFor(seed, from);
+    std::uniform_real_distribution<double> factor(1.0 - amount, 1.0 + amount);
+    double* row = weights.data() + from * n;
+    graph.FillRow(from, row);
+    for (size_t to = 0; to < n; ++to) {
+      if (to != from && row[to] != Graph::kInfinity) {
+        row[to] *= factor(rng);
+      }
+    }
+  });
+  std::vector<std::string> labels;
+  labels.reserve(n);
+  for (size_t i = 0; i < n; ++i) {
+    labels.push_back(graph.Label(i));
+  }
+  return Graph::FromWeights(std::move(weights), n, std::move(labels));
+}
+
+}  // namespace lr4
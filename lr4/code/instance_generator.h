@@ -0,0 +1,40 @@
+#ifndef LR4_INSTANCE_GENERATOR_H
+#define LR4_INSTANCE_GENERATOR_H
+
+#include <cstddef>
+
+#include "graph.h"
+
+namespace lr4 {
+
+struct GeneratorParameters {
+  size_t vertices = 1000;
+  unsigned int seed = 42;
+  size_t max_out_degree = 15;    // sparse: out-degree is uniform in [1, max_out_degree]
+  double side = 1000.0;          // Euclidean: points lie in [0, side)^2
+  size_t clusters = 16;          // clustered: number of cluster centres
+  double cluster_spread = 0.05;  // clustered: deviation around a centre, relative to `side`
+};
+
+// Every generator draws each row (or block of points) from its own random
+// stream seeded by (seed, index), so the instance depends only on the
+// parameters and not on `thread_count`.
+
+// Random digraph with the Hamiltonian cycle v0 -> v1 -> ... -> v0 and extra
+// random out-edges; weights are uniform in [1, 100). Labels are "v0".."vN".
+Graph GenerateSparseDigraph(const GeneratorParameters& params, size_t thread_count);
+
+// Points uniform in the square; a metric EUC_2D graph with O(n) memory.
+Graph GenerateUniformEuclidean(const GeneratorParameters& params, size_t thread_count);
+
+// Points normally distributed around uniformly placed centres; EUC_2D.
+Graph GenerateClusteredEuclidean(const GeneratorParameters& params, size_t thread_count);
+
+// Dense copy of `graph` whose finite weights are scaled by independent
+// factors in [1 - amount, 1 + amount] per direction, so w(i, j) != w(j, i).
+Graph PerturbAsymmetric(const Graph& graph, double amount, unsigned int seed,
+                        size_t thread_count);
+
+}  // namespace lr4
+
+#endif  // LR4_INSTANCE_GENERATOR_H
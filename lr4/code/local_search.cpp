@@ -0,0 +1,159 @@
+#include "local_search.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace lr4 {
+namespace {
+
+bool OrOptPass(const Graph& graph,
+               const LocalSearchParameters& params,
+               std::vector<int>* cycle) {
+  std::vector<int>& t = *cycle;
+  const size_t n = t.size();
+  bool improved = false;
+  auto w = [&graph](int from, int to) {
+    return graph.Weight(static_cast<size_t>(from), static_cast<size_t>(to));
+  };
+  for (size_t length = 1; length <= params.max_segment; ++length) {
+    if (n < length + 3) {
+      break;
+    }
+    for (size_t i = 0; i + length <= n; ++i) {
+      const size_t prev_pos = (i + n - 1) % n;
+      const int prev = t[prev_pos];
+      const int first = t[i];
+      const int last = t[i + length - 1];
+      const int next = t[(i + length) % n];
+      TourCost removed_base;
+      removed_base.Add(w(prev, first));
+      removed_base.Add(w(last, next));
+      TourCost added_base;
+      added_base.Add(w(prev, next));
+
+      const size_t lo = i > params.window ? i - params.window : 0;
+      const size_t hi = std::min(n - 1, i + length - 1 + params.window);
+      for (size_t p = lo; p <= hi; ++p) {
+        if (p == prev_pos || (p >= i && p < i + length)) {
+          continue;
+        }
+        const int a = t[p];
+        const int b = t[(p + 1) % n];
+        TourCost removed = removed_base;
+        removed.Add(w(a, b));
+        TourCost added = added_base;
+        added.Add(w(a, first));
+        added.Add(w(last, b));
+        if (!(added < removed)) {
+          continue;
+        }
+        if (p >= i + length) {
+          std::rotate(t.begin() + static_cast<long>(i),
+                      t.begin() + static_cast<long>(i + length),
+                      t.begin() + static_cast<long>(p + 1));
+        } else {
+          std::rotate(t.begin() + static_cast<long>(p + 1),
+                      t.begin() + static_cast<long>(i),
+                      t.begin() + static_cast<long>(i + length));
+        }
+        improved = true;
+        break;
+      }
+    }
+  }
+  return improved;
+}
+
+}  // namespace
+
+TourCost CycleCost(const Graph& graph, const std::vector<int>& cycle) {
+  TourCost cost;
+  for (size_t i = 0; i < cycle.size(); ++i) {
+    cost.Add(graph.Weight(static_cast<size_t>(cycle[i]),
+                          static_cast<size_t>(cycle[(i + 1) % cycle.size()])));
+  }
+  return cost;
+}
+
+double TourLength(const Graph& graph, const std::vector<int>& tour) {
+  if (tour.size() < 2) {
+    return Graph::kInfinity;
+  }
+  double length = 0.0;
+  for (size_t i = 0; i + 1 < tour.size(); ++i) {
+    double weight = graph.Weight(static_cast<size_t>(tour[i]), static_cast<size_t>(tour[i + 1]));
+    if (!std::isfinite(weight)) {
+      return Graph::kInfinity;
+    }
+    length += weight;
+  }
+  return length;
+}
+
+std::vector<int> GreedyTour(const Graph& graph) {
+  const size_t n = graph.VertexCount();
+  std::vector<int> tour;
+  if (n == 0) {
+    return tour;
+  }
+  tour.reserve(n + 1);
+  std::vector<char> visited(n, 0);
+  size_t current = 0;
+  visited[current] = 1;
+  tour.push_back(0);
+  // With cached neighbour lists the first unvisited entry is the nearest
+  // unvisited vertex; the full row is only scanned when all of them are used
+  // or the nearest one is out of reach.
+  const size_t candidates = graph.NeighbourCount();
+  std::vector<double> row(n);
+  for (size_t step = 1; step < n; ++step) {
+    size_t best = n;
+    const int* neighbours = graph.Neighbours(current);
+    for (size_t k = 0; k < candidates; ++k) {
+      const size_t next = static_cast<size_t>(neighbours[k]);
+      if (!visited[next]) {
+        if (graph.Weight(current, next) < Graph::kInfinity) {
+          best = next;
+        }
+        break;
+      }
+    }
+    if (best == n) {
+      graph.FillRow(current, row.data());
+      double best_weight = Graph::kInfinity;
+      for (size_t next = 0; next < n; ++next) {
+        if (visited[next]) {
+          continue;
+        }
+        if (best == n || row[next] < best_weight) {
+          best = next;
+          best_weight = row[next];
+        }
+      }
+    }
+    current = best;
+    visited[current] = 1;
+    tour.push_back(static_cast<int>(current));
+  }
+  tour.push_back(tour.front());
+  return tour;
+}
+
+double ImproveTour(const Graph& graph,
+                   const LocalSearchParameters& params,
+                   std::vector<int>* tour) {
+  if (tour->size() < 2) {
+    return Graph::kInfinity;
+  }
+  std::vector<int> cycle(tour->begin(), tour->end() - 1);
+  for (size_t pass = 0; pass < params.max_passes; ++pass) {
+    if (!OrOptPass(graph, params, &cycle)) {
+      break;
+    }
+  }
+  cycle.push_back(cycle.front());
+  *tour = std::move(cycle);
+  return TourLength(graph, *tour);
+}
+
+}  // namespace lr4
@@ -0,0 +1,63 @@
+#ifndef LR4_LOCAL_SEARCH_H
+#define LR4_LOCAL_SEARCH_H
+
+#include <cstddef>
+#include <vector>
+
+#include "graph.h"
+
+namespace lr4 {
+
+struct LocalSearchParameters {
+  size_t window = 32;       // insertion points examined on each side of a segment
+  size_t max_segment = 3;   // longest run of vertices moved by or-opt
+  size_t max_passes = 8;    // full sweeps over the tour before giving up
+};
+
+// Tour cost that counts missing edges apart from the finite weight sum, so
+// comparisons stay exact when a tour mixes finite and infinite edges.
+struct TourCost {
+  long long missing = 0;
+  double finite = 0.0;
+
+  void Add(double weight) {
+    if (weight < Graph::kInfinity) {
+      finite += weight;
+    } else {
+      ++missing;
+    }
+  }
+  TourCost operator+(const TourCost& other) const {
+    return TourCost{missing + other.missing, finite + other.finite};
+  }
+  bool operator<(const TourCost& other) const {
+    if (missing != other.missing) {
+      return missing < other.missing;
+    }
+    return finite + 1e-9 < other.finite;
+  }
+};
+
+// Cost of an open cycle (without the repeated start vertex), closing edge included.
+TourCost CycleCost(const Graph& graph, const std::vector<int>& cycle);
+
+// Length of a closed tour (front == back); infinity if any edge is missing.
+double TourLength(const Graph& graph, const std::vector<int>& tour);
+
+// Closed nearest-neighbour tour from vertex 0. When no edge leads on from the
+// current vertex, the next unvisited vertex is taken anyway, so the result may
+// contain missing edges on sparse graphs. Cached neighbour lists of the graph
+// (Graph::BuildNeighbours) turn most steps into O(1) lookups.
+std::vector<int> GreedyTour(const Graph& graph);
+
+// Improves a closed tour in place with or-opt moves. Segments keep their
+// orientation, so the moves are valid on directed graphs. Missing edges are
+// treated as infinitely expensive, which lets the search repair infeasible
+// tours. Returns the length of the resulting tour.
+double ImproveTour(const Graph& graph,
+                   const LocalSearchParameters& params,
+                   std::vector<int>* tour);
+
+}  // namespace lr4
+
+#endif  // LR4_LOCAL_SEARCH_H
@@ -2,15 +2,26 @@
 #include <cmath>
 #include <cstdlib>
 #include <exception>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <map>
 #include <optional>
+#include <stdexcept>
 #include <string>
 #include <thread>
+#include <utility>
+#include <vector>
 
+#include "annealing_solver.h"
 #include "ant_colony_solver.h"
+#include "decomposition_solver.h"
+#include "genetic_solver.h"
 #include "graph.h"
+#include "portfolio_solver.h"
+#include "solver_metrics.h"
+#include "tabu_solver.h"
+#include "trace_recorder.h"
 
 namespace {
 
@@ -23,6 +34,20 @@ struct Options {
   bool only_parallel = false;
 bool print_paths = true;
   unsigned int seed = 42;
+  std::string engine = "aco";
+  size_t cluster_size = 64;
+  size_t steps = 200000;
+  size_t population = 64;
+  size_t generations = 200;
+  lr4::Crossover crossover = lr4::Crossover::kOrder;
+  size_t tabu_iterations = 20000;
+  double time_limit_ms = 10000.0;
+  size_t neighbours = 0;
+  bool profile = false;
+  std::string trace_path;
+  std::string stats_path;
+  std::string metrics_path;
+  size_t metrics_interval_ms = 10000;
 };
 
 Options ParseArgs(int argc, char** argv) {
@@ -71,13 +96,124 @@ Options ParseArgs(int argc, char** argv) {
   if (auto value = get("--print-paths")) {
     options.print_paths = value == std::nullopt || *value != "false";
   }
+  if (auto value = get("--engine")) {
+    options.engine = *value;
+    if (options.engine != "aco" && options.engine != "decomposition" &&
+        options.engine != "annealing" && options.engine != "ga" && options.engine != "tabu" &&
+        options.engine != "portfolio") {
+      throw std::invalid_argument("Unknown engine: " + options.engine);
+    }
+  }
+  if (auto value = get("--steps")) {
+    options.steps = static_cast<size_t>(std::stoul(*value));
+  }
+  if (auto value = get("--population")) {
+    options.population = static_cast<size_t>(std::stoul(*value));
+  }
+  if (auto value = get("--generations")) {
+    options.generations = static_cast<size_t>(std::stoul(*value));
+  }
+  if (auto value = get("--crossover")) {
+    if (*value == "ox") {
+      options.crossover = lr4::Crossover::kOrder;
+    } else if (*value == "erx") {
+      options.crossover = lr4::Crossover::kEdgeRecombination;
+    } else {
+      throw std::invalid_argument("Unknown crossover: " + *value);
+    }
+  }
+  if (auto value = get("--tabu-iterations")) {
+    options.tabu_iterations = static_cast<size_t>(std::stoul(*value));
+  }
+  if (auto value = get("--time-limit")) {
+    options.time_limit_ms = std::stod(*value);
+    if (!(options.time_limit_ms > 0.0) || options.time_limit_ms > 1e9) {
+      throw std::invalid_argument("Time limit must be in (0, 1e9] ms");
+    }
+  }
+  if (auto value = get("--metrics")) {
+    options.metrics_path = *value;
+  }
+  if (auto value = get("--metrics-interval")) {
+    options.metrics_interval_ms = std::max<size_t>(1, static_cast<size_t>(std::stoul(*value)));
+  }
+  if (auto value = get("--stats")) {
+    options.stats_path = *value;
+  }
+  if (auto value = get("--trace")) {
+    options.trace_path = *value;
+  }
+  if (auto value = get("--profile")) {
+    options.profile = *value != "false";
+  }
+  if (auto value = get("--neighbours")) {
+    options.neighbours = static_cast<size_t>(std::stoul(*value));
+  }
+  if (auto value = get("--cluster-size")) {
+    options.cluster_size = static_cast<size_t>(std::stoul(*value));
+    if (options.cluster_size == 0) {
+      options.cluster_size = 1;
+    }
+  }
+  if (!options.stats_path.empty() && options.engine != "aco") {
+    throw std::invalid_argument("--stats is only supported with --engine=aco");
+  }
   return options;
 }
 
+// Files ending in .tsp are read as TSPLIB, everything else as Graphviz DOT.
+lr4::Graph LoadGraph(const std::string& path) {
+  const std::string extension = ".tsp";
+  if (path.size() >= extension.size() &&
+      path.compare(path.size() - extension.size(), extension.size(), extension) == 0) {
+    return lr4::Graph::FromTsplibFile(path);
+  }
+  return lr4::Graph::FromGraphvizFile(path);
+}
+
+// Phases in the main thread are wall-clock time; phases of worker threads are
+// summed over the workers and also listed per worker.
+void PrintProfile(const lr4::TourResult& result) {
+  std::cout << "Время по фазам, мс";
+  if (!result.thread_phase_ms.empty()) {
+    std::cout << " (фазы рабочих потоков — сумма по потокам)";
+  }
+  std::cout << ":\n" << std::setprecision(2);
+  for (size_t phase = 0; phase < lr4::kPhaseCount; ++phase) {
+    if (result.phase_ms[phase] > 0.0) {
+      std::cout << "  " << std::left << std::setw(14)
+                << lr4::PhaseName(static_cast<lr4::Phase>(phase)) << std::right << std::setw(12)
+                << result.phase_ms[phase] << "\n";
+    }
+  }
+  for (size_t t = 0; t < result.thread_phase_ms.size(); ++t) {
+    std::cout << "  поток " << t << ":";
+    for (size_t phase = 0; phase < lr4::kPhaseCount; ++phase) {
+      if (result.thread_phase_ms[t][phase] > 0.0) {
+        std::cout << ' ' << lr4::PhaseName(static_cast<lr4::Phase>(phase)) << '='
+                  << result.thread_phase_ms[t][phase];
+      }
+    }
+    std::cout << "\n";
+  }
+  const lr4::SyncStats& sync = result.sync;
+  if (sync.barriers > 0 || sync.lock_acquisitions > 0) {
+    std::cout << "Синхронизация: барьеров " << sync.barriers << ", захватов блокировки "
+              << sync.lock_acquisitions << " (с ожиданием " << sync.contended_acquisitions
+              << ", " << sync.lock_wait_ms << " мс)\n";
+    std::cout << "  простой на барьерах, мс:";
+    for (double idle : sync.barrier_idle_ms) {
+      std::cout << ' ' << idle;
+    }
+    std::cout << "\n";
+  }
+}
+
 void PrintResult(const std::string& title,
                  const lr4::TourResult& result,
                  const lr4::Graph& graph,
-                 bool print_paths) {
+                 bool print_paths,
+                 bool profile) {
   std::cout << "== " << title << " ==\n";
   if (!std::isfinite(result.best_length)) {
     std::cout << "Не удалось построить допустимый цикл." << std::endl;
@@ -87,6 +223,9 @@ void PrintResult(const std::string& title,
             << result.best_length << "\n";
   std::cout << "Количество маршрутов с оптимальной длиной: " << result.best_paths.size() << "\n";
   std::cout << "Время выполнения: " << std::setprecision(2) << result.elapsed_ms << " мс\n";
+  if (profile) {
+    PrintProfile(result);
+  }
   if (print_paths) {
     for (size_t i = 0; i < result.best_paths.size(); ++i) {
       std::cout << "Маршрут " << (i + 1) << ": ";
@@ -103,27 +242,109 @@ void PrintResult(const std::string& title,
   std::cout << std::endl;
 }
 
+// One row per colony iteration of every listed run.
+void WriteIterationStats(const std::string& path,
+                         const std::vector<std::pair<std::string, lr4::TourResult>>& runs) {
+  std::ofstream out(path);
+  if (!out) {
+    throw std::runtime_error("Unable to open output file: " + path);
+  }
+  out << "variant,iteration,iteration_best,mean,worst,best_so_far,branching,dead_ends\n";
+  out << std::setprecision(9);
+  for (const auto& [variant, result] : runs) {
+    for (const lr4::IterationStats& stats : result.iterations) {
+      out << variant << ',' << stats.iteration << ',' << stats.iteration_best << ','
+          << stats.mean << ',' << stats.worst << ',' << stats.best_so_far << ','
+          << stats.branching << ',' << stats.dead_ends << "\n";
+    }
+  }
+}
+
 }  // namespace
 
 int main(int argc, char** argv) {
   try {
     Options options = ParseArgs(argc, argv);
-    lr4::Graph graph = lr4::Graph::FromGraphvizFile(options.graph_path);
+    lr4::ScopedTraceFile trace(options.trace_path);
+    lr4::MetricsFileWriter metrics(options.metrics_path,
+                                   std::chrono::milliseconds(options.metrics_interval_ms));
+    lr4::Graph graph = LoadGraph(options.graph_path);
+    if (options.neighbours > 0) {
+      graph.BuildNeighbours(options.neighbours, options.threads);
+    }
     lr4::AntColonySolver solver(graph);
     lr4::AntColonyParameters params;
     params.ants = options.ants;
     params.iterations = options.iterations;
     params.seed = options.seed;
+    params.iteration_stats = !options.stats_path.empty();
     std::cout << "Граф содержит вершин: " << graph.VertexCount() << "\n";
     std::cout << "Настройки: муравьёв=" << params.ants << ", итераций=" << params.iterations
               << ", потоки=" << options.threads << "\n\n";
+    if (options.engine == "decomposition") {
+      lr4::DecompositionParameters decomposition;
+      decomposition.cluster_size = options.cluster_size;
+      decomposition.colony.seed = options.seed;
+      lr4::DecompositionSolver decomposition_solver(graph);
+      lr4::TourResult tour = decomposition_solver.Run(decomposition, options.threads);
+      PrintResult("Декомпозиция графа", tour, graph, options.print_paths, options.profile);
+      return EXIT_SUCCESS;
+    }
+    if (options.engine == "annealing") {
+      lr4::AnnealingParameters annealing;
+      annealing.steps = options.steps;
+      annealing.seed = options.seed;
+      lr4::AnnealingSolver annealing_solver(graph);
+      lr4::TourResult tour = annealing_solver.Run(annealing, options.threads);
+      PrintResult("Имитация отжига", tour, graph, options.print_paths, options.profile);
+      return EXIT_SUCCESS;
+    }
+    if (options.engine == "ga") {
+      lr4::GeneticParameters genetic;
+      genetic.population = options.population;
+      genetic.generations = options.generations;
+      genetic.crossover = options.crossover;
+      genetic.seed = options.seed;
+      lr4::GeneticSolver genetic_solver(graph);
+      lr4::TourResult tour = genetic_solver.Run(genetic, options.threads);
+      PrintResult("Генетический алгоритм", tour, graph, options.print_paths, options.profile);
+      return EXIT_SUCCESS;
+    }
+    if (options.engine == "tabu") {
+      lr4::TabuParameters tabu;
+      tabu.iterations = options.tabu_iterations;
+      lr4::TabuSolver tabu_solver(graph);
+      lr4::TourResult tour = tabu_solver.Run(tabu, options.threads);
+      PrintResult("Поиск с запретами", tour, graph, options.print_paths, options.profile);
+      return EXIT_SUCCESS;
+    }
+    if (options.engine == "portfolio") {
+      lr4::PortfolioParameters portfolio;
+      portfolio.time_limit_ms = options.time_limit_ms;
+      portfolio.colony = params;
+      portfolio.annealing.seed = options.seed;
+      portfolio.genetic.seed = options.seed;
+      portfolio.genetic.population = options.population;
+      portfolio.genetic.crossover = options.crossover;
+      lr4::PortfolioSolver portfolio_solver(graph);
+      lr4::TourResult tour = portfolio_solver.Run(portfolio, options.threads);
+      PrintResult("Портфель решателей", tour, graph, options.print_paths, options.profile);
+      return EXIT_SUCCESS;
+    }
+    std::vector<std::pair<std::string, lr4::TourResult>> runs;
     if (!options.only_parallel) {
       lr4::TourResult seq = solver.RunSequential(params);
-      PrintResult("Последовательный алгоритм", seq, graph, options.print_paths);
+      PrintResult("Последовательный алгоритм", seq, graph, options.print_paths, options.profile);
+      runs.emplace_back("sequential", std::move(seq));
     }
     if (!options.only_sequential) {
       lr4::TourResult par = solver.RunParallel(params, options.threads);
-      PrintResult("Параллельный алгоритм", par, graph, options.print_paths);
+      PrintResult("Параллельный алгоритм", par, graph, options.print_paths, options.profile);
+      runs.emplace_back("parallel", std::move(par));
+    }
+    if (!options.stats_path.empty()) {
+      WriteIterationStats(options.stats_path, runs);
+      std::cout << "Статистика итераций сохранена в " << options.stats_path << std::endl;
     }
     return EXIT_SUCCESS;
   } catch (const std::exception& ex) {
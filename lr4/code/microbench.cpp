@@ -0,0 +1,344 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <new>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "ant_colony_solver.h"
+#include "graph.h"
+#include "instance_generator.h"
+
+// Every allocation of the process is counted, so a kernel's bytes/op
+// include whatever the standard containers it uses allocate.
+namespace {
+
+std::atomic<size_t> g_allocations{0};
+std::atomic<size_t> g_allocated_bytes{0};
+
+void* CountedAllocate(size_t size) {
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  g_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+  if (void* pointer = std::malloc(size == 0 ? 1 : size)) {
+    return pointer;
+  }
+  throw std::bad_alloc();
+}
+
+}  // namespace
+
+void* operator new(size_t size) { return CountedAllocate(size); }
+void* operator new[](size_t size) { return CountedAllocate(size); }
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, size_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { std::free(pointer); }
+
+namespace lr4 {
+
+// Thin access to the private kernels of AntColonySolver.
+class AntColonyMicrobench {
+ public:
+  using AntPath = AntColonySolver::AntPath;
+  using Matrix = std::vector<std::vector<double>>;
+
+  explicit AntColonyMicrobench(const Graph& graph) : solver_(graph) {}
+
+  AntPath ConstructSolution(std::mt19937& rng, const AntColonyParameters& params,
+                            const Matrix& pheromone) const {
+    return solver_.ConstructSolution(rng, params, pheromone);
+  }
+  static void DepositPheromone(const AntPath& path, double q, Matrix* deltas) {
+    AntColonySolver::DepositPheromone(path, q, deltas);
+  }
+  static void Evaporate(double evaporation, const Matrix& delta, Matrix* pheromone) {
+    AntColonySolver::Evaporate(evaporation, delta, pheromone);
+  }
+  void UpdateBest(const AntPath& candidate, std::vector<std::vector<int>>* best_paths,
+                  double* best_length, std::vector<std::string>* best_labels) const {
+    solver_.UpdateBest(candidate, best_paths, best_length, best_labels);
+  }
+  Matrix InitialPheromone() const { return solver_.InitialPheromone(); }
+  double ComputePathLength(const std::vector<int>& path) const {
+    return solver_.ComputePathLength(path);
+  }
+
+ private:
+  AntColonySolver solver_;
+};
+
+}  // namespace lr4
+
+namespace {
+
+struct Options {
+  std::vector<size_t> sizes = {10, 100, 1000, 10000};
+  double min_time_ms = 200.0;   // every kernel repeats until it has run this long
+  std::string filter;           // only kernels whose name contains this text
+  std::string output;           // optional CSV
+  unsigned int seed = 42;
+};
+
+std::vector<std::string> Split(std::string_view text, char delimiter) {
+  std::vector<std::string> result;
+  std::string current;
+  for (char ch : text) {
+    if (ch == delimiter) {
+      if (!current.empty()) {
+        result.push_back(current);
+        current.clear();
+      }
+    } else {
+      current.push_back(ch);
+    }
+  }
+  if (!current.empty()) {
+    result.push_back(current);
+  }
+  return result;
+}
+
+Options ParseArgs(int argc, char** argv) {
+  Options options;
+  std::map<std::string, std::string> kv;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    size_t eq = arg.find('=');
+    if (eq == std::string::npos) {
+      kv[arg] = "true";
+    } else {
+      kv[arg.substr(0, eq)] = arg.substr(eq + 1);
+    }
+  }
+  auto get = [&](const std::string& key) -> std::optional<std::string> {
+    auto it = kv.find(key);
+    if (it == kv.end()) {
+      return std::nullopt;
+    }
+    return it->second;
+  };
+  if (auto value = get("--sizes")) {
+    std::vector<size_t> parsed;
+    for (const std::string& token : Split(*value, ',')) {
+      parsed.push_back(static_cast<size_t>(std::stoull(token)));
+    }
+    if (!parsed.empty()) {
+      options.sizes = std::move(parsed);
+    }
+  }
+  if (auto value = get("--min-time")) {
+    options.min_time_ms = std::stod(*value);
+  }
+  if (auto value = get("--filter")) {
+    options.filter = *value;
+  }
+  if (auto value = get("--output")) {
+    options.output = *value;
+  }
+  if (auto value = get("--seed")) {
+    options.seed = static_cast<unsigned int>(std::stoul(*value));
+  }
+  return options;
+}
+
+// Keeps the compiler from discarding a result that is otherwise unused.
+template <typename T>
+void DoNotOptimize(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct KernelResult {
+  std::string kernel;
+  size_t size = 0;
+  size_t ops = 0;
+  double ns_per_op = 0.0;
+  double bytes_per_op = 0.0;
+  double allocations_per_op = 0.0;
+};
+
+// One untimed call, then calls of `op` until `min_time_ms` has passed.
+// `op` returns the number of operations it performed.
+template <typename Op>
+KernelResult Measure(const std::string& kernel, size_t size, double min_time_ms, Op op) {
+  op();
+  size_t ops = 0;
+  const size_t allocations = g_allocations.load();
+  const size_t bytes = g_allocated_bytes.load();
+  auto start = std::chrono::steady_clock::now();
+  double elapsed_ms = 0.0;
+  do {
+    ops += op();
+    elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+                     .count();
+  } while (elapsed_ms < min_time_ms);
+  KernelResult result;
+  result.kernel = kernel;
+  result.size = size;
+  result.ops = ops;
+  result.ns_per_op = elapsed_ms * 1e6 / static_cast<double>(ops);
+  result.bytes_per_op = static_cast<double>(g_allocated_bytes.load() - bytes) / ops;
+  result.allocations_per_op = static_cast<double>(g_allocations.load() - allocations) / ops;
+  return result;
+}
+
+// Dense Euclidean instance: the kernels see a stored matrix, as with DOT input.
+lr4::Graph BuildDenseGraph(size_t n, unsigned int seed) {
+  lr4::GeneratorParameters generator;
+  generator.vertices = std::max<size_t>(2, n);
+  generator.seed = seed;
+  lr4::Graph points = lr4::GenerateUniformEuclidean(generator, 1);
+  std::vector<double> weights(generator.vertices * generator.vertices);
+  for (size_t from = 0; from < generator.vertices; ++from) {
+    points.FillRow(from, weights.data() + from * generator.vertices);
+  }
+  return lr4::Graph::FromWeights(std::move(weights), generator.vertices);
+}
+
+std::string BuildGraphviz(size_t n, unsigned int seed) {
+  lr4::GeneratorParameters generator;
+  generator.vertices = std::max<size_t>(2, n);
+  generator.seed = seed;
+  lr4::Graph graph = lr4::GenerateSparseDigraph(generator, 1);
+  std::ostringstream oss;
+  oss << "digraph G {\n" << std::fixed << std::setprecision(6);
+  for (size_t from = 0; from < graph.VertexCount(); ++from) {
+    for (size_t to = 0; to < graph.VertexCount(); ++to) {
+      double weight = graph.Weight(from, to);
+      if (from != to && weight != lr4::Graph::kInfinity) {
+        oss << "  " << graph.Label(from) << " -> " << graph.Label(to) << " [weight=" << weight
+            << "];\n";
+      }
+    }
+  }
+  oss << "}\n";
+  return oss.str();
+}
+
+void RunSize(const Options& options, size_t n, std::vector<KernelResult>* results) {
+  auto wanted = [&options](const std::string& kernel) {
+    return options.filter.empty() || kernel.find(options.filter) != std::string::npos;
+  };
+  auto report = [results](KernelResult result) {
+    std::cout << "  " << std::left << std::setw(20) << result.kernel << std::right << std::fixed
+              << std::setprecision(1) << std::setw(16) << result.ns_per_op << " нс/оп"
+              << std::setw(14) << result.bytes_per_op << " байт/оп" << std::setprecision(2)
+              << std::setw(10) << result.allocations_per_op << " выделений/оп"
+              << std::defaultfloat << std::endl;
+    results->push_back(std::move(result));
+  };
+  const double min_ms = options.min_time_ms;
+
+  if (wanted("FromGraphviz")) {
+    const std::string text = BuildGraphviz(n, options.seed);
+    KernelResult result = Measure("FromGraphviz", n, min_ms, [&text]() {
+      std::istringstream input(text);
+      lr4::Graph graph = lr4::Graph::FromGraphviz(input);
+      DoNotOptimize(graph.VertexCount());
+      return size_t{1};
+    });
+    const double megabytes_per_second = static_cast<double>(text.size()) / result.ns_per_op * 1e3;
+    report(std::move(result));
+    std::cout << "  " << std::setw(20) << "" << std::setw(14) << std::setprecision(4)
+              << megabytes_per_second << " МБ/с входного текста" << std::endl;
+  }
+
+  const lr4::Graph graph = BuildDenseGraph(n, options.seed);
+  const lr4::AntColonyMicrobench kernels(graph);
+  lr4::AntColonyParameters params;
+  params.seed = options.seed;
+  auto pheromone = kernels.InitialPheromone();
+  auto delta = pheromone;
+  std::mt19937 rng(options.seed);
+  const lr4::AntColonyMicrobench::AntPath path = kernels.ConstructSolution(rng, params, pheromone);
+
+  if (wanted("ConstructSolution")) {
+    report(Measure("ConstructSolution", n, min_ms, [&]() {
+      DoNotOptimize(kernels.ConstructSolution(rng, params, pheromone).length);
+      return size_t{1};
+    }));
+  }
+  if (wanted("DepositPheromone")) {
+    report(Measure("DepositPheromone", n, min_ms, [&]() {
+      lr4::AntColonyMicrobench::DepositPheromone(path, params.q, &delta);
+      DoNotOptimize(delta[0][0]);
+      return size_t{1};
+    }));
+  }
+  if (wanted("Evaporate")) {
+    for (auto& row : delta) {
+      std::fill(row.begin(), row.end(), 0.0);
+    }
+    report(Measure("Evaporate", n, min_ms, [&]() {
+      lr4::AntColonyMicrobench::Evaporate(params.evaporation, delta, &pheromone);
+      DoNotOptimize(pheromone[0][0]);
+      return size_t{1};
+    }));
+  }
+  if (wanted("UpdateBest")) {
+    std::vector<std::vector<int>> best_paths;
+    std::vector<std::string> best_labels;
+    double best_length = lr4::Graph::kInfinity;
+    // After the warm-up call every candidate ties with the best tour, which
+    // is the branch that canonicalises and compares labels.
+    report(Measure("UpdateBest", n, min_ms, [&]() {
+      kernels.UpdateBest(path, &best_paths, &best_length, &best_labels);
+      return size_t{1};
+    }));
+  }
+  if (wanted("CanonicalizeTour")) {
+    report(Measure("CanonicalizeTour", n, min_ms, [&]() {
+      DoNotOptimize(graph.CanonicalizeTour(path.path).front());
+      return size_t{1};
+    }));
+  }
+  if (wanted("ComputePathLength")) {
+    report(Measure("ComputePathLength", n, min_ms, [&]() {
+      DoNotOptimize(kernels.ComputePathLength(path.path));
+      return size_t{1};
+    }));
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  try {
+    Options options = ParseArgs(argc, argv);
+    std::vector<KernelResult> results;
+    for (size_t n : options.sizes) {
+      std::cout << "Размер " << n << ":" << std::endl;
+      RunSize(options, n, &results);
+    }
+    if (!options.output.empty()) {
+      std::ofstream csv(options.output);
+      if (!csv) {
+        throw std::runtime_error("Unable to open output file: " + options.output);
+      }
+      csv << "kernel,size,ops,ns_per_op,bytes_per_op,allocations_per_op\n";
+      csv << std::fixed << std::setprecision(3);
+      for (const KernelResult& result : results) {
+        csv << result.kernel << ',' << result.size << ',' << result.ops << ','
+            << result.ns_per_op << ',' << result.bytes_per_op << ','
+            << result.allocations_per_op << "\n";
+      }
+      std::cout << "Результаты сохранены в " << options.output << std::endl;
+    }
+    return EXIT_SUCCESS;
+  } catch (const std::exception& ex) {
+    std::cerr << "Ошибка: " << ex.what() << std::endl;
+  }
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,199 @@
+#ifndef LR4_PARALLEL_H
+#define LR4_PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace lr4 {
+
+// Lock acquisitions of one thread, merged into SyncStats after it is joined.
+struct LockCounter {
+  size_t acquisitions = 0;
+  size_t contended = 0;
+  std::chrono::steady_clock::duration wait{0};
+};
+
+// Synchronisation overhead of a parallel run; times are in milliseconds.
+struct SyncStats {
+  size_t lock_acquisitions = 0;
+  size_t contended_acquisitions = 0;    // found the mutex held and had to wait
+  double lock_wait_ms = 0.0;            // summed over threads
+  size_t barriers = 0;                  // joins or pool rounds
+  // Per worker: time between finishing its share and the end of the barrier.
+  std::vector<double> barrier_idle_ms;
+
+  void Add(const LockCounter& counter) {
+    lock_acquisitions += counter.acquisitions;
+    contended_acquisitions += counter.contended;
+    lock_wait_ms += std::chrono::duration<double, std::milli>(counter.wait).count();
+  }
+};
+
+// Locks `mutex`, counting the acquisition and, if the mutex was held, how
+// long it took. An uncontended acquisition costs no clock reads.
+inline std::unique_lock<std::mutex> LockCounted(std::mutex& mutex, LockCounter* counter) {
+  ++counter->acquisitions;
+  if (mutex.try_lock()) {
+    return std::unique_lock<std::mutex>(mutex, std::adopt_lock);
+  }
+  ++counter->contended;
+  const auto begin = std::chrono::steady_clock::now();
+  std::unique_lock<std::mutex> lock(mutex);
+  counter->wait += std::chrono::steady_clock::now() - begin;
+  return lock;
+}
+
+// Runs fn(index, worker) for every index in [0, count) on up to thread_count
+// threads. Indices are handed out dynamically, so uneven work items balance
+// themselves; `worker` is stable per thread and can address per-thread state.
+template <typename Fn>
+void ParallelFor(size_t count, size_t thread_count, Fn&& fn) {
+  const size_t workers_count = std::max<size_t>(1, std::min(thread_count, count));
+  if (workers_count <= 1) {
+    for (size_t index = 0; index < count; ++index) {
+      fn(index, size_t{0});
+    }
+    return;
+  }
+  std::atomic<size_t> next{0};
+  std::vector<std::thread> workers;
+  workers.reserve(workers_count);
+  for (size_t t = 0; t < workers_count; ++t) {
+    workers.emplace_back([&, t]() {
+      for (size_t index = next.fetch_add(1); index < count; index = next.fetch_add(1)) {
+        fn(index, t);
+      }
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+}
+
+// Persistent set of worker threads for loops that are too short to pay for
+// spawning threads on every call. The calling thread takes part as worker 0,
+// so a pool of size 1 has no background threads and runs everything inline.
+// Every parallel round is a barrier; Stats() reports how many there were and
+// how long each worker idled in them.
+class WorkerPool {
+ public:
+  explicit WorkerPool(size_t thread_count)
+      : finished_(std::max<size_t>(1, thread_count)),
+        idle_(std::max<size_t>(1, thread_count), std::chrono::steady_clock::duration{0}) {
+    for (size_t t = 1; t < thread_count; ++t) {
+      threads_.emplace_back([this, t]() { Loop(t); });
+    }
+  }
+
+  ~WorkerPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+      ++generation_;
+    }
+    start_cv_.notify_all();
+    for (auto& thread : threads_) {
+      thread.join();
+    }
+  }
+
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+
+  size_t Size() const { return threads_.size() + 1; }
+
+  // Barrier statistics of all rounds so far. Call between rounds.
+  SyncStats Stats() const {
+    SyncStats stats;
+    stats.barriers = rounds_;
+    for (auto idle : idle_) {
+      stats.barrier_idle_ms.push_back(std::chrono::duration<double, std::milli>(idle).count());
+    }
+    return stats;
+  }
+
+  // Same contract as the free ParallelFor; returns once every index is done.
+  template <typename Fn>
+  void ParallelFor(size_t count, Fn&& fn) {
+    if (threads_.empty() || count <= 1) {
+      for (size_t index = 0; index < count; ++index) {
+        fn(index, size_t{0});
+      }
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      context_ = &fn;
+      invoke_ = [](void* context, size_t index, size_t worker) {
+        (*static_cast<std::remove_reference_t<Fn>*>(context))(index, worker);
+      };
+      count_ = count;
+      next_.store(0);
+      active_ = threads_.size();
+      ++generation_;
+    }
+    start_cv_.notify_all();
+    Drain(0);
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [this]() { return active_ == 0; });
+    const auto end = std::chrono::steady_clock::now();
+    ++rounds_;
+    for (size_t worker = 0; worker < finished_.size(); ++worker) {
+      idle_[worker] += end - finished_[worker];
+    }
+  }
+
+ private:
+  void Loop(size_t worker) {
+    size_t seen = 0;
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        start_cv_.wait(lock, [&]() { return generation_ != seen; });
+        seen = generation_;
+        if (stop_) {
+          return;
+        }
+      }
+      Drain(worker);
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (--active_ == 0) {
+        done_cv_.notify_one();
+      }
+    }
+  }
+
+  void Drain(size_t worker) {
+    for (size_t index = next_.fetch_add(1); index < count_; index = next_.fetch_add(1)) {
+      invoke_(context_, index, worker);
+    }
+    // Published to the caller by the mutex taken when the worker reports.
+    finished_[worker] = std::chrono::steady_clock::now();
+  }
+
+  std::vector<std::thread> threads_;
+  std::mutex mutex_;
+  std::condition_variable start_cv_;
+  std::condition_variable done_cv_;
+  size_t generation_ = 0;
+  size_t active_ = 0;
+  bool stop_ = false;
+  void* context_ = nullptr;
+  void (*invoke_)(void*, size_t, size_t) = nullptr;
+  size_t count_ = 0;
+  std::atomic<size_t> next_{0};
+  size_t rounds_ = 0;
+  std::vector<std::chrono::steady_clock::time_point> finished_;
+  std::vector<std::chrono::steady_clock::duration> idle_;
+};
+
+}  // namespace lr4
+
+#endif  // LR4_PARALLEL_H
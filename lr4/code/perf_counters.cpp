@@ -0,0 +1,167 @@
+#include "perf_counters.h"
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+namespace lr4 {
+
+namespace {
+
+struct EventSpec {
+  uint32_t type;
+  uint64_t config;
+};
+
+constexpr std::array<EventSpec, kCounterCount> kEvents = {{
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                             (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES},
+}};
+
+int OpenEvent(const EventSpec& spec, bool inherit, bool exclude_kernel) {
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = spec.type;
+  attr.config = spec.config;
+  attr.disabled = 1;
+  attr.inherit = inherit ? 1 : 0;
+  attr.exclude_kernel = exclude_kernel ? 1 : 0;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  return static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC));
+}
+
+}  // namespace
+
+const char* CounterName(Counter counter) {
+  switch (counter) {
+    case Counter::kCycles:
+      return "cycles";
+    case Counter::kInstructions:
+      return "instructions";
+    case Counter::kL1dMisses:
+      return "l1d_misses";
+    case Counter::kLlcMisses:
+      return "llc_misses";
+    case Counter::kBranchMisses:
+      return "branch_misses";
+    case Counter::kContextSwitches:
+      return "context_switches";
+  }
+  return "unknown";
+}
+
+bool CounterValues::Any() const {
+  for (double value : values) {
+    if (value >= 0.0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+double CounterValues::Ipc() const {
+  if (!Has(Counter::kCycles) || !Has(Counter::kInstructions) || Get(Counter::kCycles) <= 0.0) {
+    return -1.0;
+  }
+  return Get(Counter::kInstructions) / Get(Counter::kCycles);
+}
+
+CounterValues& CounterValues::operator+=(const CounterValues& other) {
+  for (size_t i = 0; i < kCounterCount; ++i) {
+    values[i] = values[i] >= 0.0 && other.values[i] >= 0.0 ? values[i] + other.values[i] : -1.0;
+  }
+  return *this;
+}
+
+CounterValues CounterValues::Scaled(double factor) const {
+  CounterValues scaled = *this;
+  for (double& value : scaled.values) {
+    if (value >= 0.0) {
+      value *= factor;
+    }
+  }
+  return scaled;
+}
+
+PerfCounters::PerfCounters(bool inherit, bool open) : inherit_(inherit) {
+  fds_.fill(-1);
+  if (open) {
+    Open();
+  }
+}
+
+void PerfCounters::Open() {
+  Close();
+  for (size_t i = 0; i < kCounterCount; ++i) {
+    // Kernel-side counts need perf_event_paranoid < 2; fall back to user
+    // space only, which still sees every cycle the solver itself spends.
+    int fd = OpenEvent(kEvents[i], inherit_, false);
+    if (fd < 0 && (errno == EACCES || errno == EPERM)) {
+      fd = OpenEvent(kEvents[i], inherit_, true);
+    }
+    if (fd < 0 && error_.empty()) {
+      error_ = std::string(CounterName(static_cast<Counter>(i))) + ": " + std::strerror(errno);
+    }
+    fds_[i] = fd;
+  }
+}
+
+void PerfCounters::Close() {
+  for (int& fd : fds_) {
+    if (fd >= 0) {
+      ::close(fd);
+      fd = -1;
+    }
+  }
+}
+
+bool PerfCounters::Available() const {
+  for (int fd : fds_) {
+    if (fd >= 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void PerfCounters::Start() {
+  for (int fd : fds_) {
+    if (fd >= 0) {
+      ::ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+      ::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+}
+
+CounterValues PerfCounters::Stop() {
+  CounterValues result;
+  for (size_t i = 0; i < kCounterCount; ++i) {
+    if (fds_[i] < 0) {
+      continue;
+    }
+    ::ioctl(fds_[i], PERF_EVENT_IOC_DISABLE, 0);
+    uint64_t data[3] = {0, 0, 0};  // value, time enabled, time running
+    if (::read(fds_[i], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data))) {
+      continue;
+    }
+    double value = static_cast<double>(data[0]);
+    if (data[2] != 0 && data[2] < data[1]) {
+      value *= static_cast<double>(data[1]) / static_cast<double>(data[2]);
+    }
+    result.values[i] = data[1] == 0 || data[2] != 0 ? value : -1.0;
+  }
+  return result;
+}
+
+}  // namespace lr4
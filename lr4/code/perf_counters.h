@@ -0,0 +1,82 @@
+#ifndef LR4_PERF_COUNTERS_H
+#define LR4_PERF_COUNTERS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace lr4 {
+
+enum class Counter {
+  kCycles,
+  kInstructions,
+  kL1dMisses,         // L1 data cache read misses
+  kLlcMisses,         // last-level cache misses
+  kBranchMisses,
+  kContextSwitches,
+};
+
+constexpr size_t kCounterCount = 6;
+
+// Column name of a counter in the benchmark output, e.g. "llc_misses".
+const char* CounterName(Counter counter);
+
+// Counts of one measured interval; a counter the kernel or the hardware does
+// not provide stays negative.
+struct CounterValues {
+  std::array<double, kCounterCount> values;
+
+  CounterValues() { values.fill(-1.0); }
+
+  double Get(Counter counter) const { return values[static_cast<size_t>(counter)]; }
+  bool Has(Counter counter) const { return Get(counter) >= 0.0; }
+  bool Any() const;
+  // Instructions per cycle, or a negative value if either count is missing.
+  double Ipc() const;
+
+  // Adds the counters present in both operands; the others stay missing.
+  CounterValues& operator+=(const CounterValues& other);
+  CounterValues Scaled(double factor) const;
+};
+
+// Hardware and software counters of the calling thread, read through
+// perf_event_open(2). With `inherit`, threads the caller creates while the
+// counters are open are counted as well, once they have been joined. Every
+// counter is opened on its own, so a missing PMU event (virtual machines,
+// containers, perf_event_paranoid) only drops that counter; when nothing can
+// be opened, Available() is false and Stop() returns all counters missing.
+class PerfCounters {
+ public:
+  // With `open` false nothing is opened until Open(), so the object can be
+  // created ahead of the thread that will use it.
+  explicit PerfCounters(bool inherit, bool open = true);
+  ~PerfCounters() { Close(); }
+
+  PerfCounters(const PerfCounters&) = delete;
+  PerfCounters& operator=(const PerfCounters&) = delete;
+
+  bool Available() const;
+  // Reason the first counter could not be opened, empty if all were.
+  const std::string& Error() const { return error_; }
+
+  // Opens the counters on the calling thread, closing any open ones. Only
+  // the first failure is recorded, so reopening allocates nothing.
+  void Open();
+  void Close();
+
+  // Resets and enables the counters.
+  void Start();
+  // Disables the counters and returns the counts since Start(), scaled up
+  // when the kernel had to multiplex them.
+  CounterValues Stop();
+
+ private:
+  bool inherit_;
+  std::array<int, kCounterCount> fds_;
+  std::string error_;
+};
+
+}  // namespace lr4
+
+#endif  // LR4_PERF_COUNTERS_H
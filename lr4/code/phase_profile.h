@@ -0,0 +1,87 @@
+#ifndef LR4_PHASE_PROFILE_H
+#define LR4_PHASE_PROFILE_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace lr4 {
+
+enum class Phase {
+  kConstruction,   // building tours (ants, clusters)
+  kLocalSearch,    // improving a finished tour
+  kDeposit,        // laying pheromone into the per-iteration deltas
+  kReduction,      // merging per-thread deltas
+  kEvaporation,
+  kBestUpdate,     // comparing with and recording the best tours
+  kBarrierWait,    // a worker done with its share, waiting for the join
+};
+
+constexpr size_t kPhaseCount = 7;
+
+using PhaseTicks = std::array<uint64_t, kPhaseCount>;
+using PhaseTimes = std::array<double, kPhaseCount>;
+
+inline const char* PhaseName(Phase phase) {
+  switch (phase) {
+    case Phase::kConstruction:
+      return "construction";
+    case Phase::kLocalSearch:
+      return "local_search";
+    case Phase::kDeposit:
+      return "deposit";
+    case Phase::kReduction:
+      return "reduction";
+    case Phase::kEvaporation:
+      return "evaporation";
+    case Phase::kBestUpdate:
+      return "best_update";
+    case Phase::kBarrierWait:
+      return "barrier_wait";
+  }
+  return "unknown";
+}
+
+// Time stamp counter where available (a few cycles per read, constant rate
+// on every CPU of the last decade), otherwise the steady clock in ns. Ticks
+// are converted to milliseconds once per run, against the steady clock.
+inline uint64_t ReadTimestamp() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                   std::chrono::steady_clock::now().time_since_epoch())
+                                   .count());
+#endif
+}
+
+// Adds the ticks since *mark to `phase` and moves *mark to now.
+inline void Lap(Phase phase, uint64_t* mark, PhaseTicks* ticks) {
+  const uint64_t now = ReadTimestamp();
+  (*ticks)[static_cast<size_t>(phase)] += now - *mark;
+  *mark = now;
+}
+
+// Converts `ticks` using an interval of `reference_ticks` that took
+// `reference_ms` on the steady clock.
+inline PhaseTimes TicksToMilliseconds(const PhaseTicks& ticks, uint64_t reference_ticks,
+                                      double reference_ms) {
+  PhaseTimes times{};
+  if (reference_ticks == 0) {
+    return times;
+  }
+  const double ms_per_tick = reference_ms / static_cast<double>(reference_ticks);
+  for (size_t i = 0; i < kPhaseCount; ++i) {
+    times[i] = static_cast<double>(ticks[i]) * ms_per_tick;
+  }
+  return times;
+}
+
+}  // namespace lr4
+
+#endif  // LR4_PHASE_PROFILE_H
@@ -0,0 +1,97 @@
+#include "portfolio_solver.h"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <thread>
+
+namespace lr4 {
+namespace {
+
+constexpr size_t kUnbounded = std::numeric_limits<size_t>::max();
+
+struct ColonyVariant {
+  double alpha;
+  double beta;
+};
+
+// Colony members differ in the balance between pheromone and distance.
+constexpr ColonyVariant kColonyVariants[] = {{1.0, 3.0}, {1.0, 5.0}, {2.0, 2.0}};
+
+}  // namespace
+
+PortfolioSolver::PortfolioSolver(const Graph& graph) : graph_(graph) {}
+
+std::vector<std::string> PortfolioSolver::MemberNames() {
+  return {"tabu", "aco(1,3)", "annealing", "aco(1,5)", "ga", "aco(2,2)"};
+}
+
+TourResult PortfolioSolver::Run(const PortfolioParameters& params, size_t thread_count) const {
+  TourResult result;
+  if (thread_count == 0 || graph_.VertexCount() == 0) {
+    return result;
+  }
+  auto start = std::chrono::steady_clock::now();
+  SearchControl control(params.time_limit_ms);
+  const size_t members = std::min(MemberNames().size(), thread_count);
+  std::vector<std::thread> racers;
+  racers.reserve(members);
+  for (size_t member = 0; member < members; ++member) {
+    size_t share = thread_count / members + (member < thread_count % members ? 1 : 0);
+    racers.emplace_back([&, member, share]() { RunMember(member, params, share, &control); });
+  }
+  for (auto& racer : racers) {
+    racer.join();
+  }
+  std::vector<int> tour;
+  if (control.TakeIfBetter(Graph::kInfinity, &tour)) {
+    result = SingleTourResult(graph_, tour);
+  }
+  auto end = std::chrono::steady_clock::now();
+  result.elapsed_ms = std::chrono::duration<double, std::milli>(end - start).count();
+  return result;
+}
+
+void PortfolioSolver::RunMember(size_t member,
+                                const PortfolioParameters& params,
+                                size_t thread_count,
+                                SearchControl* control) const {
+  // Every member runs until the deadline; iteration budgets are lifted.
+  switch (member) {
+    case 0: {
+      TabuParameters tabu = params.tabu;
+      tabu.iterations = kUnbounded;
+      TabuSolver(graph_).Run(tabu, thread_count, control);
+      break;
+    }
+    case 2: {
+      AnnealingParameters annealing = params.annealing;
+      annealing.steps = kUnbounded / 2;
+      AnnealingSolver(graph_).Run(annealing, thread_count, control);
+      break;
+    }
+    case 4: {
+      GeneticParameters genetic = params.genetic;
+      genetic.generations = kUnbounded;
+      GeneticSolver(graph_).Run(genetic, thread_count, control);
+      break;
+    }
+    default: {
+      const ColonyVariant& variant = kColonyVariants[member / 2];
+      AntColonyParameters colony = params.colony;
+      colony.alpha = variant.alpha;
+      colony.beta = variant.beta;
+      colony.iterations = kUnbounded;
+      colony.seed += static_cast<unsigned int>(member * 7919);
+      AntColonySolver solver(graph_);
+      if (thread_count > 1) {
+        solver.RunParallel(colony, thread_count, control);
+      } else {
+        solver.RunSequential(colony, control);
+      }
+      break;
+    }
+  }
+}
+
+}  // namespace lr4
@@ -0,0 +1,49 @@
+#ifndef LR4_PORTFOLIO_SOLVER_H
+#define LR4_PORTFOLIO_SOLVER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "annealing_solver.h"
+#include "ant_colony_solver.h"
+#include "genetic_solver.h"
+#include "graph.h"
+#include "tabu_solver.h"
+
+namespace lr4 {
+
+struct PortfolioParameters {
+  double time_limit_ms = 10000.0;   // wall-clock budget of the whole race
+  AntColonyParameters colony;       // base settings of the colony members
+  AnnealingParameters annealing;
+  GeneticParameters genetic;
+  TabuParameters tabu;
+};
+
+// Races several engine configurations on disjoint shares of the threads.
+// The members share a SearchControl: each publishes its improvements to the
+// atomic incumbent slot and picks up shorter tours found by the others. The
+// race ends at the deadline and returns the incumbent.
+class PortfolioSolver {
+ public:
+  explicit PortfolioSolver(const Graph& graph);
+
+  TourResult Run(const PortfolioParameters& params, size_t thread_count) const;
+
+  // Members in the order they are given threads; with fewer threads than
+  // members only the first ones run.
+  static std::vector<std::string> MemberNames();
+
+ private:
+  void RunMember(size_t member,
+                 const PortfolioParameters& params,
+                 size_t thread_count,
+                 SearchControl* control) const;
+
+  const Graph& graph_;
+};
+
+}  // namespace lr4
+
+#endif  // LR4_PORTFOLIO_SOLVER_H
@@ -0,0 +1,48 @@
+#include "search_control.h"
+
+#include <algorithm>
+
+namespace lr4 {
+
+SearchControl::SearchControl(double time_limit_ms)
+    : start_(std::chrono::steady_clock::now()),
+      deadline_(start_ + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                             std::chrono::duration<double, std::milli>(time_limit_ms))) {}
+
+bool SearchControl::Expired() const {
+  return stopped_.load(std::memory_order_relaxed) ||
+         std::chrono::steady_clock::now() >= deadline_;
+}
+
+double SearchControl::Progress() const {
+  double total = std::chrono::duration<double>(deadline_ - start_).count();
+  if (total <= 0.0) {
+    return 1.0;
+  }
+  double used = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+  return std::clamp(used / total, 0.0, 1.0);
+}
+
+bool SearchControl::Offer(const std::vector<int>& tour, double length) {
+  if (!(length + 1e-9 < BestLength())) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!(length + 1e-9 < best_length_.load(std::memory_order_relaxed))) {
+    return false;
+  }
+  best_tour_ = tour;
+  best_length_.store(length, std::memory_order_release);
+  return true;
+}
+
+bool SearchControl::TakeIfBetter(double length, std::vector<int>* tour) const {
+  if (!(BestLength() + 1e-9 < length)) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  *tour = best_tour_;
+  return !tour->empty();
+}
+
+}  // namespace lr4
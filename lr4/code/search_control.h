@@ -0,0 +1,47 @@
+#ifndef LR4_SEARCH_CONTROL_H
+#define LR4_SEARCH_CONTROL_H
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+#include "graph.h"
+
+namespace lr4 {
+
+// State shared by engines racing on one instance: a deadline and the best
+// tour found so far by any of them. The incumbent length is an atomic, so
+// engines can compare against it on every iteration without locking; the
+// tour itself is copied under a mutex only when it actually improves.
+class SearchControl {
+ public:
+  explicit SearchControl(double time_limit_ms);
+
+  // True once the deadline has passed or Stop() was called.
+  bool Expired() const;
+  void Stop() { stopped_.store(true, std::memory_order_relaxed); }
+
+  // Fraction of the time limit already used, in [0, 1].
+  double Progress() const;
+
+  double BestLength() const { return best_length_.load(std::memory_order_acquire); }
+
+  // Publishes a closed tour (front == back) if it beats the incumbent.
+  bool Offer(const std::vector<int>& tour, double length);
+
+  // Copies the incumbent into `tour` if it is shorter than `length`.
+  bool TakeIfBetter(double length, std::vector<int>* tour) const;
+
+ private:
+  std::chrono::steady_clock::time_point start_;
+  std::chrono::steady_clock::time_point deadline_;
+  std::atomic<bool> stopped_{false};
+  std::atomic<double> best_length_{Graph::kInfinity};
+  mutable std::mutex mutex_;
+  std::vector<int> best_tour_;
+};
+
+}  // namespace lr4
+
+#endif  // LR4_SEARCH_CONTROL_H
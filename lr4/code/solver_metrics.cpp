@@ -0,0 +1,180 @@
+#include "solver_metrics.h"
+
+#include <unistd.h>
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <utility>
+
+namespace lr4 {
+
+namespace {
+
+const char* VariantLabel(size_t variant) {
+  return variant == static_cast<size_t>(SolveVariant::kParallel) ? "parallel" : "sequential";
+}
+
+uint64_t ToMicroseconds(double ms) {
+  return ms > 0.0 ? static_cast<uint64_t>(std::llround(ms * 1000.0)) : 0;
+}
+
+}  // namespace
+
+std::atomic<SolverMetrics*> SolverMetrics::active_{nullptr};
+
+void SolverMetrics::Install(SolverMetrics* metrics) {
+  active_.store(metrics, std::memory_order_release);
+}
+
+void SolverMetrics::AddIteration(SolveVariant variant, size_t ants, size_t dead_ends) {
+  Variant& target = variants_[static_cast<size_t>(variant)];
+  target.iterations.fetch_add(1, std::memory_order_relaxed);
+  target.ants.fetch_add(ants, std::memory_order_relaxed);
+  if (dead_ends != 0) {
+    target.dead_ends.fetch_add(dead_ends, std::memory_order_relaxed);
+  }
+}
+
+void SolverMetrics::AddSolve(SolveVariant variant, double elapsed_ms, double busy_ms,
+                             double available_ms) {
+  Variant& target = variants_[static_cast<size_t>(variant)];
+  size_t bucket = 0;
+  while (bucket < kLatencyBuckets.size() && elapsed_ms > kLatencyBuckets[bucket] * 1000.0) {
+    ++bucket;
+  }
+  target.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+  target.latency_us.fetch_add(ToMicroseconds(elapsed_ms), std::memory_order_relaxed);
+  target.busy_us.fetch_add(ToMicroseconds(busy_ms), std::memory_order_relaxed);
+  target.available_us.fetch_add(ToMicroseconds(available_ms), std::memory_order_relaxed);
+  // Counted last, so a reader never sees a solve without its latency.
+  target.solves.fetch_add(1, std::memory_order_release);
+}
+
+void SolverMetrics::WritePrometheus(std::ostream& out) const {
+  struct Snapshot {
+    double solves, iterations, ants, dead_ends, latency_s, busy_s, available_s;
+    std::array<double, kLatencyBuckets.size() + 1> buckets;
+  };
+  std::array<Snapshot, kSolveVariantCount> snapshots;
+  for (size_t v = 0; v < kSolveVariantCount; ++v) {
+    const Variant& source = variants_[v];
+    Snapshot& snapshot = snapshots[v];
+    snapshot.solves = static_cast<double>(source.solves.load(std::memory_order_acquire));
+    snapshot.iterations = static_cast<double>(source.iterations.load(std::memory_order_relaxed));
+    snapshot.ants = static_cast<double>(source.ants.load(std::memory_order_relaxed));
+    snapshot.dead_ends = static_cast<double>(source.dead_ends.load(std::memory_order_relaxed));
+    snapshot.latency_s = source.latency_us.load(std::memory_order_relaxed) / 1e6;
+    snapshot.busy_s = source.busy_us.load(std::memory_order_relaxed) / 1e6;
+    snapshot.available_s = source.available_us.load(std::memory_order_relaxed) / 1e6;
+    for (size_t b = 0; b < snapshot.buckets.size(); ++b) {
+      snapshot.buckets[b] = static_cast<double>(source.buckets[b].load(std::memory_order_relaxed));
+    }
+  }
+  auto family = [&out](const char* name, const char* type, const char* help) {
+    out << "# HELP " << name << ' ' << help << "\n# TYPE " << name << ' ' << type << "\n";
+  };
+  auto series = [&](const char* name, double Snapshot::*field) {
+    for (size_t v = 0; v < kSolveVariantCount; ++v) {
+      out << name << "{variant=\"" << VariantLabel(v) << "\"} " << snapshots[v].*field << "\n";
+    }
+  };
+  auto ratio = [&](const char* name, double Snapshot::*numerator, double Snapshot::*denominator) {
+    for (size_t v = 0; v < kSolveVariantCount; ++v) {
+      const double below = snapshots[v].*denominator;
+      out << name << "{variant=\"" << VariantLabel(v) << "\"} "
+          << (below > 0.0 ? snapshots[v].*numerator / below : 0.0) << "\n";
+    }
+  };
+  out.precision(12);
+
+  family("lr4_solves_total", "counter", "Completed ant colony runs.");
+  series("lr4_solves_total", &Snapshot::solves);
+  family("lr4_iterations_total", "counter", "Colony iterations.");
+  series("lr4_iterations_total", &Snapshot::iterations);
+  family("lr4_ants_total", "counter", "Ants sent out.");
+  series("lr4_ants_total", &Snapshot::ants);
+  family("lr4_dead_end_ants_total", "counter", "Ants that did not complete a tour.");
+  series("lr4_dead_end_ants_total", &Snapshot::dead_ends);
+  family("lr4_worker_busy_seconds_total", "counter", "Worker time spent on ants.");
+  series("lr4_worker_busy_seconds_total", &Snapshot::busy_s);
+  family("lr4_worker_available_seconds_total", "counter", "Worker count times run time.");
+  series("lr4_worker_available_seconds_total", &Snapshot::available_s);
+
+  family("lr4_solve_duration_seconds", "histogram", "Wall-clock time of a run.");
+  for (size_t v = 0; v < kSolveVariantCount; ++v) {
+    const Snapshot& snapshot = snapshots[v];
+    double cumulative = 0.0;
+    for (size_t b = 0; b < snapshot.buckets.size(); ++b) {
+      cumulative += snapshot.buckets[b];
+      out << "lr4_solve_duration_seconds_bucket{variant=\"" << VariantLabel(v) << "\",le=\"";
+      if (b < kLatencyBuckets.size()) {
+        out << kLatencyBuckets[b];
+      } else {
+        out << "+Inf";
+      }
+      out << "\"} " << cumulative << "\n";
+    }
+    out << "lr4_solve_duration_seconds_sum{variant=\"" << VariantLabel(v) << "\"} "
+        << snapshot.latency_s << "\n";
+    out << "lr4_solve_duration_seconds_count{variant=\"" << VariantLabel(v) << "\"} "
+        << cumulative << "\n";
+  }
+
+  // Averages since the start of the process, for readers without PromQL;
+  // rate() over the counters above gives the windowed values.
+  family("lr4_iterations_per_second", "gauge", "Iterations per second of solve time.");
+  ratio("lr4_iterations_per_second", &Snapshot::iterations, &Snapshot::latency_s);
+  family("lr4_ants_per_second", "gauge", "Ants per second of solve time.");
+  ratio("lr4_ants_per_second", &Snapshot::ants, &Snapshot::latency_s);
+  family("lr4_dead_end_ratio", "gauge", "Share of ants that did not complete a tour.");
+  ratio("lr4_dead_end_ratio", &Snapshot::dead_ends, &Snapshot::ants);
+  family("lr4_worker_utilisation", "gauge", "Busy share of the available worker time.");
+  ratio("lr4_worker_utilisation", &Snapshot::busy_s, &Snapshot::available_s);
+}
+
+MetricsFileWriter::MetricsFileWriter(std::string path, std::chrono::milliseconds interval)
+    : path_(std::move(path)), interval_(interval) {
+  if (path_.empty()) {
+    return;
+  }
+  SolverMetrics::Install(&metrics_);
+  thread_ = std::thread([this]() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_cv_.wait_for(lock, interval_, [this]() { return stop_; })) {
+      Write();
+    }
+  });
+}
+
+MetricsFileWriter::~MetricsFileWriter() {
+  if (path_.empty()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  stop_cv_.notify_all();
+  thread_.join();
+  SolverMetrics::Install(nullptr);
+  Write();
+}
+
+void MetricsFileWriter::Write() const {
+  const std::string temporary = path_ + ".tmp" + std::to_string(::getpid());
+  {
+    std::ofstream out(temporary);
+    if (!out) {
+      std::cerr << "Не удалось записать метрики в " << temporary << std::endl;
+      return;
+    }
+    metrics_.WritePrometheus(out);
+  }
+  if (std::rename(temporary.c_str(), path_.c_str()) != 0) {
+    std::cerr << "Не удалось переименовать " << temporary << " в " << path_ << std::endl;
+  }
+}
+
+}  // namespace lr4
@@ -0,0 +1,85 @@
+#ifndef LR4_SOLVER_METRICS_H
+#define LR4_SOLVER_METRICS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+
+namespace lr4 {
+
+enum class SolveVariant { kSequential, kParallel };
+
+constexpr size_t kSolveVariantCount = 2;
+
+// Process-wide counters and histograms of the ant colony runs, exposed in the
+// Prometheus text format. Solvers update them with relaxed atomic adds: once
+// per iteration for the throughput counters and once per run for the rest,
+// so a run with metrics enabled does a handful of atomic adds per iteration.
+class SolverMetrics {
+ public:
+  // Upper bounds of the solve latency buckets, in seconds; +Inf is implied.
+  static constexpr std::array<double, 12> kLatencyBuckets = {
+      0.001, 0.005, 0.01, 0.05, 0.1, 0.5, 1.0, 5.0, 10.0, 30.0, 60.0, 300.0};
+
+  // Makes `metrics` the instance solvers report to; nullptr stops reporting.
+  static void Install(SolverMetrics* metrics);
+  static SolverMetrics* Active() { return active_.load(std::memory_order_acquire); }
+
+  void AddIteration(SolveVariant variant, size_t ants, size_t dead_ends);
+  // `busy_ms` is the time workers spent on ants, `available_ms` the thread
+  // count times the wall-clock time of the run.
+  void AddSolve(SolveVariant variant, double elapsed_ms, double busy_ms, double available_ms);
+
+  void WritePrometheus(std::ostream& out) const;
+
+ private:
+  struct Variant {
+    std::atomic<uint64_t> solves{0};
+    std::atomic<uint64_t> iterations{0};
+    std::atomic<uint64_t> ants{0};
+    std::atomic<uint64_t> dead_ends{0};
+    std::atomic<uint64_t> latency_us{0};
+    std::atomic<uint64_t> busy_us{0};
+    std::atomic<uint64_t> available_us{0};
+    std::array<std::atomic<uint64_t>, kLatencyBuckets.size() + 1> buckets{};
+  };
+
+  static std::atomic<SolverMetrics*> active_;
+
+  std::array<Variant, kSolveVariantCount> variants_;
+};
+
+// Installs `metrics` and rewrites `path` every `interval` from a background
+// thread, and once more on destruction. The file is written under a
+// temporary name and renamed, so readers such as the node_exporter textfile
+// collector never see a partial file. An empty path does nothing.
+class MetricsFileWriter {
+ public:
+  MetricsFileWriter(std::string path, std::chrono::milliseconds interval);
+  ~MetricsFileWriter();
+
+  MetricsFileWriter(const MetricsFileWriter&) = delete;
+  MetricsFileWriter& operator=(const MetricsFileWriter&) = delete;
+
+ private:
+  void Write() const;
+
+  std::string path_;
+  std::chrono::milliseconds interval_;
+  SolverMetrics metrics_;
+  std::mutex mutex_;
+  std::condition_variable stop_cv_;
+  bool stop_ = false;
+  std::thread thread_;
+};
+
+}  // namespace lr4
+
+#endif  // LR4_SOLVER_METRICS_H
@@ -0,0 +1,218 @@
+#include "statistics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+
+namespace lr4 {
+
+double Percentile(const std::vector<double>& sorted, double fraction) {
+  if (sorted.empty()) {
+    return 0.0;
+  }
+  const double rank = std::clamp(fraction, 0.0, 1.0) * static_cast<double>(sorted.size() - 1);
+  const size_t lower = static_cast<size_t>(std::floor(rank));
+  const size_t upper = std::min(lower + 1, sorted.size() - 1);
+  const double weight = rank - static_cast<double>(lower);
+  if (weight == 0.0 || sorted[lower] == sorted[upper]) {
+    return sorted[lower];   // also keeps infinite samples from turning into NaN
+  }
+  return sorted[lower] + weight * (sorted[upper] - sorted[lower]);
+}
+
+SampleSummary Summarize(const std::vector<double>& samples, size_t resamples, unsigned int seed) {
+  SampleSummary summary;
+  summary.count = samples.size();
+  if (samples.empty()) {
+    return summary;
+  }
+  std::vector<double> sorted = samples;
+  std::sort(sorted.begin(), sorted.end());
+  const double n = static_cast<double>(sorted.size());
+  summary.mean = std::accumulate(sorted.begin(), sorted.end(), 0.0) / n;
+  if (sorted.size() > 1) {
+    double squares = 0.0;
+    for (double value : sorted) {
+      squares += (value - summary.mean) * (value - summary.mean);
+    }
+    summary.stddev = std::sqrt(squares / (n - 1.0));
+  }
+  summary.min = sorted.front();
+  summary.max = sorted.back();
+  summary.median = Percentile(sorted, 0.5);
+  summary.p90 = Percentile(sorted, 0.9);
+  summary.p99 = Percentile(sorted, 0.99);
+
+  const double q1 = Percentile(sorted, 0.25);
+  const double q3 = Percentile(sorted, 0.75);
+  const double fence = 1.5 * (q3 - q1);
+  for (double value : sorted) {
+    if (value < q1 - fence || value > q3 + fence) {
+      ++summary.outliers;
+    }
+  }
+
+  summary.median_ci_low = summary.median;
+  summary.median_ci_high = summary.median;
+  if (sorted.size() > 1 && resamples > 0) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<size_t> pick(0, sorted.size() - 1);
+    std::vector<double> medians(resamples);
+    std::vector<double> resample(sorted.size());
+    for (double& median : medians) {
+      for (double& value : resample) {
+        value = sorted[pick(rng)];
+      }
+      std::sort(resample.begin(), resample.end());
+      median = Percentile(resample, 0.5);
+    }
+    std::sort(medians.begin(), medians.end());
+    summary.median_ci_low = Percentile(medians, 0.025);
+    summary.median_ci_high = Percentile(medians, 0.975);
+  }
+  return summary;
+}
+
+double TimeToTarget(const std::vector<TracePoint>& trace, double target) {
+  for (const TracePoint& point : trace) {
+    if (point.best_length <= target) {
+      return point.elapsed_ms;
+    }
+  }
+  return std::numeric_limits<double>::infinity();
+}
+
+double QualityAt(const std::vector<TracePoint>& trace, double deadline_ms) {
+  double best = std::numeric_limits<double>::infinity();
+  for (const TracePoint& point : trace) {
+    if (point.elapsed_ms > deadline_ms) {
+      break;
+    }
+    best = point.best_length;
+  }
+  return best;
+}
+
+namespace {
+
+// Least-squares slope of y = s x through the origin, clamped to [0, 1].
+double FitThroughOrigin(const std::vector<double>& x, const std::vector<double>& y) {
+  double xy = 0.0;
+  double xx = 0.0;
+  for (size_t i = 0; i < x.size(); ++i) {
+    xy += x[i] * y[i];
+    xx += x[i] * x[i];
+  }
+  if (xx <= 0.0) {
+    return 0.0;
+  }
+  return std::clamp(xy / xx, 0.0, 1.0);
+}
+
+}  // namespace
+
+double AmdahlSerialFraction(const std::vector<size_t>& threads,
+                            const std::vector<double>& speedups) {
+  // 1 / S - 1 / p = s (1 - 1 / p)
+  std::vector<double> x;
+  std::vector<double> y;
+  for (size_t i = 0; i < threads.size() && i < speedups.size(); ++i) {
+    if (threads[i] < 2 || !(speedups[i] > 0.0)) {
+      continue;
+    }
+    const double p = static_cast<double>(threads[i]);
+    x.push_back(1.0 - 1.0 / p);
+    y.push_back(1.0 / speedups[i] - 1.0 / p);
+  }
+  return FitThroughOrigin(x, y);
+}
+
+double GustafsonSerialFraction(const std::vector<size_t>& threads,
+                               const std::vector<double>& scaled_speedups) {
+  // p - S = s (p - 1)
+  std::vector<double> x;
+  std::vector<double> y;
+  for (size_t i = 0; i < threads.size() && i < scaled_speedups.size(); ++i) {
+    if (threads[i] < 2 || !std::isfinite(scaled_speedups[i])) {
+      continue;
+    }
+    const double p = static_cast<double>(threads[i]);
+    x.push_back(p - 1.0);
+    y.push_back(p - scaled_speedups[i]);
+  }
+  return FitThroughOrigin(x, y);
+}
+
+std::vector<std::string> SplitCsvRow(const std::string& line) {
+  std::vector<std::string> cells(1);
+  for (char ch : line) {
+    if (ch == ',') {
+      cells.emplace_back();
+    } else if (ch != '\r') {
+      cells.back().push_back(ch);
+    }
+  }
+  return cells;
+}
+
+Baseline ParseBaseline(std::istream& input) {
+  std::string line;
+  if (!std::getline(input, line)) {
+    throw std::runtime_error("Baseline file is empty");
+  }
+  const std::vector<std::string> header = SplitCsvRow(line);
+  auto column = [&header](const char* name) {
+    auto it = std::find(header.begin(), header.end(), name);
+    if (it == header.end()) {
+      throw std::runtime_error(std::string("Baseline file has no column ") + name);
+    }
+    return static_cast<size_t>(it - header.begin());
+  };
+  const size_t vertices = column("vertices");
+  const size_t variant = column("variant");
+  const size_t threads = column("threads");
+  const size_t median = column("median_ms");
+  const size_t ci_low = column("median_ci_low_ms");
+  const size_t ci_high = column("median_ci_high_ms");
+  const size_t needed = std::max({vertices, variant, threads, median, ci_low, ci_high}) + 1;
+  Baseline baseline;
+  for (size_t row = 2; std::getline(input, line); ++row) {
+    if (line.empty() || line == "\r") {
+      continue;
+    }
+    const std::vector<std::string> cells = SplitCsvRow(line);
+    if (cells.size() < needed) {
+      throw std::runtime_error("Baseline row " + std::to_string(row) + " has " +
+                               std::to_string(cells.size()) + " cells, expected at least " +
+                               std::to_string(needed));
+    }
+    ConfigurationKey key{static_cast<size_t>(std::stoull(cells[vertices])), cells[variant],
+                         static_cast<size_t>(std::stoull(cells[threads]))};
+    baseline[key] = BaselineEntry{std::stod(cells[median]), std::stod(cells[ci_low]),
+                                  std::stod(cells[ci_high])};
+  }
+  return baseline;
+}
+
+MedianChange CompareMedians(const BaselineEntry& baseline, const SampleSummary& current,
+                            double threshold) {
+  MedianChange result;
+  if (!(baseline.median_ms > 0.0)) {
+    return result;
+  }
+  result.change = current.median / baseline.median_ms - 1.0;
+  result.low = baseline.median_ci_high_ms > 0.0
+                   ? current.median_ci_low / baseline.median_ci_high_ms - 1.0
+                   : result.change;
+  result.high = baseline.median_ci_low_ms > 0.0
+                    ? current.median_ci_high / baseline.median_ci_low_ms - 1.0
+                    : result.change;
+  result.regression = result.low > threshold;
+  result.improvement = result.high < -threshold;
+  return result;
+}
+
+}  // namespace lr4
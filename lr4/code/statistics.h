@@ -0,0 +1,95 @@
+#ifndef LR4_STATISTICS_H
+#define LR4_STATISTICS_H
+
+#include <cstddef>
+#include <istream>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "ant_colony_solver.h"
+
+namespace lr4 {
+
+struct SampleSummary {
+  size_t count = 0;
+  double mean = 0.0;
+  double stddev = 0.0;          // sample standard deviation
+  double min = 0.0;
+  double max = 0.0;
+  double median = 0.0;
+  double p90 = 0.0;
+  double p99 = 0.0;
+  double median_ci_low = 0.0;   // 95% bootstrap confidence interval of the median
+  double median_ci_high = 0.0;
+  size_t outliers = 0;          // samples beyond 1.5 IQR outside the quartiles (Tukey)
+};
+
+// Percentile of an ascending sample with linear interpolation between the
+// closest ranks; `fraction` is in [0, 1].
+double Percentile(const std::vector<double>& sorted, double fraction);
+
+// Summary of repeated measurements. The confidence interval comes from
+// `resamples` bootstrap resamples drawn with a fixed seed, so reruns on the
+// same samples give the same interval.
+SampleSummary Summarize(const std::vector<double>& samples, size_t resamples = 2000,
+                        unsigned int seed = 1);
+
+// Time at which a best-so-far trace first reaches `target` or better;
+// infinity when it never does.
+double TimeToTarget(const std::vector<TracePoint>& trace, double target);
+
+// Best length of a trace at `deadline_ms`; infinity before its first point.
+double QualityAt(const std::vector<TracePoint>& trace, double deadline_ms);
+
+// Serial fraction s of Amdahl's law, S(p) = 1 / (s + (1 - s) / p), fitted by
+// least squares on 1 / S to strong-scaling speedups measured at `threads`.
+// Points with a single thread carry no information; the result is clamped
+// to [0, 1].
+double AmdahlSerialFraction(const std::vector<size_t>& threads,
+                            const std::vector<double>& speedups);
+
+// Serial fraction s of Gustafson's law, S(p) = p - s (p - 1), for weak
+// scaling, where the scaled speedup is S(p) = p T(1) / T(p). Clamped to [0, 1].
+double GustafsonSerialFraction(const std::vector<size_t>& threads,
+                               const std::vector<double>& scaled_speedups);
+
+// Median of one benchmark configuration of an earlier run, with its 95%
+// confidence interval.
+struct BaselineEntry {
+  double median_ms = 0.0;
+  double median_ci_low_ms = 0.0;
+  double median_ci_high_ms = 0.0;
+};
+
+using ConfigurationKey = std::tuple<size_t, std::string, size_t>;  // vertices, variant, threads
+using Baseline = std::map<ConfigurationKey, BaselineEntry>;
+
+// Cells of one CSV line, empty ones included, also at the end of the line.
+std::vector<std::string> SplitCsvRow(const std::string& line);
+
+// Reads a benchmark results CSV. Columns are found by name, so files with
+// more or fewer columns load as long as the six that are read are present;
+// a row must reach the last of those. Throws std::runtime_error otherwise.
+Baseline ParseBaseline(std::istream& input);
+
+// Relative change of a median against the baseline, with an interval built
+// from the two 95% confidence intervals (current low over baseline high,
+// current high over baseline low). A regression is a change whose
+// optimistic end is still slower than `threshold`, an improvement one whose
+// pessimistic end is faster than -threshold.
+struct MedianChange {
+  double change = 0.0;
+  double low = 0.0;
+  double high = 0.0;
+  bool regression = false;
+  bool improvement = false;
+};
+
+MedianChange CompareMedians(const BaselineEntry& baseline, const SampleSummary& current,
+                            double threshold);
+
+}  // namespace lr4
+
+#endif  // LR4_STATISTICS_H
@@ -0,0 +1,335 @@
+#include "tabu_solver.h"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+#include "parallel.h"
+
+namespace lr4 {
+
+TabuSolver::TabuSolver(const Graph& graph) : graph_(graph) {}
+
+TourResult TabuSolver::Run(const TabuParameters& params, size_t thread_count,
+                           SearchControl* control) const {
+  TourResult result;
+  const size_t n = graph_.VertexCount();
+  if (thread_count == 0 || n == 0) {
+    return result;
+  }
+  auto start = std::chrono::steady_clock::now();
+  std::vector<int> tour = GreedyTour(graph_);
+  tour.pop_back();
+  std::vector<int> best_tour = tour;
+  std::vector<TracePoint> trace;
+  SyncStats sync;
+  const size_t max_segment = std::max<size_t>(1, params.max_segment);
+  const size_t window = std::max<size_t>(1, params.window);
+  if (n >= max_segment + 5) {
+    // A move starting at position q reads the tour within `margin` of q.
+    const size_t margin = window + max_segment + 1;
+    std::vector<size_t> position(n);
+    std::vector<size_t> tabu_until(n, 0);
+    std::vector<std::vector<int>> expiring(params.tenure + 1);
+    size_t moves = 0;
+
+    std::vector<Move> table(n);
+    auto better = [&](size_t a, size_t b) {
+      if (a >= n || table[a].kind == MoveKind::kNone) {
+        return false;
+      }
+      if (b >= n || table[b].kind == MoveKind::kNone) {
+        return true;
+      }
+      if (table[a].delta < table[b].delta) {
+        return true;
+      }
+      if (table[b].delta < table[a].delta) {
+        return false;
+      }
+      return a < b;
+    };
+    // Tournament tree over positions; the root holds the best move overall.
+    size_t leaves = 1;
+    while (leaves < n) {
+      leaves *= 2;
+    }
+    std::vector<size_t> tree(2 * leaves, n);
+    auto update_tree = [&](size_t q) {
+      size_t node = q + leaves;
+      tree[node] = q;
+      for (node /= 2; node >= 1; node /= 2) {
+        size_t left = tree[2 * node];
+        size_t right = tree[2 * node + 1];
+        tree[node] = better(right, left) ? right : left;
+      }
+    };
+
+    WorkerPool pool(thread_count);
+    auto rebuild = [&]() {
+      for (size_t k = 0; k < n; ++k) {
+        position[static_cast<size_t>(tour[k])] = k;
+      }
+      pool.ParallelFor(n, [&](size_t q, size_t) {
+        table[q] = BestMoveAt(tour, tabu_until, moves, q, params);
+      });
+      for (size_t q = 0; q < n; ++q) {
+        tree[q + leaves] = q;
+      }
+      for (size_t node = leaves - 1; node >= 1; --node) {
+        size_t left = tree[2 * node];
+        size_t right = tree[2 * node + 1];
+        tree[node] = better(right, left) ? right : left;
+      }
+    };
+    rebuild();
+
+    std::vector<char> dirty(n, 0);
+    std::vector<size_t> work;
+    auto mark_range = [&](size_t lo, size_t hi) {
+      for (size_t k = lo; k <= hi; ++k) {
+        if (!dirty[k]) {
+          dirty[k] = 1;
+          work.push_back(k);
+        }
+      }
+    };
+    auto mark = [&](size_t center_lo, size_t center_hi) {
+      mark_range(center_lo > margin ? center_lo - margin : 0, std::min(n - 1, center_hi + margin));
+      // Moves at either end of the array also read across the wrap-around.
+      if (center_lo <= margin) {
+        mark_range(n > margin + 1 ? n - 1 - margin : 0, n - 1);
+      }
+      if (center_hi + margin >= n - 1) {
+        mark_range(0, std::min(n - 1, margin));
+      }
+    };
+
+    TourCost current = CycleCost(graph_, tour);
+    TourCost best_cost = current;
+    auto record = [&]() {
+      RecordTrace(start, best_cost.missing == 0 ? best_cost.finite : Graph::kInfinity, &trace);
+    };
+    record();
+    bool pending_best = false;
+    size_t stall = 0;
+    auto publish = [&]() {
+      if (control != nullptr && best_cost.missing == 0 && best_cost.finite < control->BestLength()) {
+        std::vector<int> closed = best_tour;
+        closed.push_back(closed.front());
+        control->Offer(closed, best_cost.finite);
+      }
+    };
+    while (moves < params.iterations) {
+      if (control != nullptr && control->Expired()) {
+        break;
+      }
+      if (stall >= params.stall_limit) {
+        std::vector<int> incumbent;
+        double best_length = best_cost.missing == 0 ? best_cost.finite : Graph::kInfinity;
+        if (control == nullptr || !control->TakeIfBetter(best_length, &incumbent)) {
+          break;
+        }
+        tour.assign(incumbent.begin(), incumbent.end() - 1);
+        current = CycleCost(graph_, tour);
+        best_cost = current;
+        best_tour = tour;
+        pending_best = false;
+        stall = 0;
+        record();
+        rebuild();
+      }
+      const size_t from = tree[1];
+      if (from >= n || table[from].kind == MoveKind::kNone) {
+        break;
+      }
+      const Move move = table[from];
+      // The current tour is only copied out when the walk leaves a new best.
+      if (pending_best && !(move.delta < TourCost{})) {
+        best_tour = tour;
+        pending_best = false;
+        publish();
+      }
+      ++moves;
+      work.clear();
+      size_t lo = from;
+      size_t hi = from;
+      auto make_tabu = [&](int vertex) {
+        if (params.tenure == 0) {
+          return;
+        }
+        tabu_until[static_cast<size_t>(vertex)] = moves + params.tenure;
+        expiring[(moves + params.tenure) % expiring.size()].push_back(vertex);
+      };
+      if (move.kind == MoveKind::kOrOpt) {
+        for (size_t k = 0; k < move.length; ++k) {
+          make_tabu(tour[from + k]);
+        }
+        if (move.target > from) {
+          std::rotate(tour.begin() + static_cast<long>(from),
+                      tour.begin() + static_cast<long>(from + move.length),
+                      tour.begin() + static_cast<long>(move.target + 1));
+          hi = move.target;
+        } else {
+          std::rotate(tour.begin() + static_cast<long>(move.target + 1),
+                      tour.begin() + static_cast<long>(from),
+                      tour.begin() + static_cast<long>(from + move.length));
+          lo = move.target + 1;
+          hi = from + move.length - 1;
+        }
+      } else {
+        make_tabu(tour[from]);
+        make_tabu(tour[move.target]);
+        std::swap(tour[from], tour[move.target]);
+        hi = move.target;
+      }
+      for (size_t k = lo; k <= hi; ++k) {
+        position[static_cast<size_t>(tour[k])] = k;
+      }
+      current = current + move.delta;
+      if (current < best_cost) {
+        best_cost = current;
+        pending_best = true;
+        stall = 0;
+        record();
+      } else {
+        ++stall;
+      }
+
+      mark(lo, hi);
+      std::vector<int>& expired = expiring[moves % expiring.size()];
+      for (int vertex : expired) {
+        if (tabu_until[static_cast<size_t>(vertex)] == moves) {
+          size_t at = position[static_cast<size_t>(vertex)];
+          mark(at, at);
+        }
+      }
+      expired.clear();
+
+      auto evaluate = [&](size_t index, size_t) {
+        size_t q = work[index];
+        table[q] = BestMoveAt(tour, tabu_until, moves, q, params);
+      };
+      if (work.size() >= params.parallel_threshold) {
+        pool.ParallelFor(work.size(), evaluate);
+      } else {
+        for (size_t index = 0; index < work.size(); ++index) {
+          evaluate(index, 0);
+        }
+      }
+      for (size_t q : work) {
+        dirty[q] = 0;
+        update_tree(q);
+      }
+    }
+    if (pending_best) {
+      best_tour = tour;
+      publish();
+    }
+    sync = pool.Stats();
+  }
+  best_tour.push_back(best_tour.front());
+  result = SingleTourResult(graph_, best_tour);
+  RecordTrace(start, result.best_length, &trace);
+  result.trace = std::move(trace);
+  result.sync = std::move(sync);
+  auto end = std::chrono::steady_clock::now();
+  result.elapsed_ms = std::chrono::duration<double, std::milli>(end - start).count();
+  return result;
+}
+
+TabuSolver::Move TabuSolver::BestMoveAt(const std::vector<int>& tour,
+                                        const std::vector<size_t>& tabu_until,
+                                        size_t iteration,
+                                        size_t position,
+                                        const TabuParameters& params) const {
+  Move best;
+  const std::vector<int>& t = tour;
+  const size_t n = t.size();
+  const size_t q = position;
+  const size_t window = std::max<size_t>(1, params.window);
+  auto tabu = [&](int vertex) { return tabu_until[static_cast<size_t>(vertex)] > iteration; };
+  auto w = [this](int from, int to) {
+    return graph_.Weight(static_cast<size_t>(from), static_cast<size_t>(to));
+  };
+  auto consider = [&best](MoveKind kind, const TourCost& added, const TourCost& removed,
+                          size_t length, size_t target) {
+    TourCost delta{added.missing - removed.missing, added.finite - removed.finite};
+    if (best.kind == MoveKind::kNone || delta < best.delta) {
+      best.kind = kind;
+      best.delta = delta;
+      best.length = length;
+      best.target = target;
+    }
+  };
+  if (tabu(t[q])) {
+    return best;
+  }
+
+  // Or-opt: move t[q..q+length) between t[p] and t[p + 1].
+  const size_t prev_pos = (q + n - 1) % n;
+  for (size_t length = 1; length <= params.max_segment && q + length <= n; ++length) {
+    if (length > 1 && tabu(t[q + length - 1])) {
+      break;
+    }
+    const int prev = t[prev_pos];
+    const int first = t[q];
+    const int last = t[q + length - 1];
+    const int next = t[(q + length) % n];
+    TourCost removed_base;
+    removed_base.Add(w(prev, first));
+    removed_base.Add(w(last, next));
+    TourCost added_base;
+    added_base.Add(w(prev, next));
+    const size_t lo = q > window ? q - window : 0;
+    const size_t hi = std::min(n - 1, q + length - 1 + window);
+    for (size_t p = lo; p <= hi; ++p) {
+      if (p == prev_pos || (p >= q && p < q + length)) {
+        continue;
+      }
+      TourCost removed = removed_base;
+      removed.Add(w(t[p], t[(p + 1) % n]));
+      TourCost added = added_base;
+      added.Add(w(t[p], first));
+      added.Add(w(last, t[(p + 1) % n]));
+      consider(MoveKind::kOrOpt, added, removed, length, p);
+    }
+  }
+
+  // Swap t[q] and t[j].
+  const size_t last_j = std::min(n - 1, q + window);
+  for (size_t j = q + 1; j <= last_j; ++j) {
+    if ((q == 0 && j == n - 1) || tabu(t[j])) {
+      continue;
+    }
+    const int a = t[prev_pos];
+    const int x = t[q];
+    const int y = t[j];
+    const int b = t[(j + 1) % n];
+    TourCost removed;
+    TourCost added;
+    if (j == q + 1) {
+      removed.Add(w(a, x));
+      removed.Add(w(x, y));
+      removed.Add(w(y, b));
+      added.Add(w(a, y));
+      added.Add(w(y, x));
+      added.Add(w(x, b));
+    } else {
+      const int x_next = t[q + 1];
+      const int y_prev = t[j - 1];
+      removed.Add(w(a, x));
+      removed.Add(w(x, x_next));
+      removed.Add(w(y_prev, y));
+      removed.Add(w(y, b));
+      added.Add(w(a, y));
+      added.Add(w(y, x_next));
+      added.Add(w(y_prev, x));
+      added.Add(w(x, b));
+    }
+    consider(MoveKind::kSwap, added, removed, 0, j);
+  }
+  return best;
+}
+
+}  // namespace lr4
@@ -0,0 +1,59 @@
+#ifndef LR4_TABU_SOLVER_H
+#define LR4_TABU_SOLVER_H
+
+#include <cstddef>
+#include <vector>
+
+#include "ant_colony_solver.h"
+#include "graph.h"
+#include "local_search.h"
+#include "search_control.h"
+
+namespace lr4 {
+
+struct TabuParameters {
+  size_t iterations = 20000;        // moves performed at most
+  size_t stall_limit = 2000;        // stop after this many moves without a new best tour
+  size_t tenure = 16;               // moves during which a moved vertex stays tabu
+  size_t window = 32;               // maximal distance between the ends of a move
+  size_t max_segment = 3;           // longest run of vertices moved by or-opt
+  size_t parallel_threshold = 64;   // positions to re-evaluate before the pool is used
+};
+
+// Deterministic tabu search over or-opt and swap moves; both keep edge
+// orientation, so directed graphs are handled. The best non-tabu move
+// starting at every tour position is kept in a table; after a move only the
+// positions whose moves can see the changed part of the tour are evaluated
+// again, in parallel when there are enough of them.
+class TabuSolver {
+ public:
+  explicit TabuSolver(const Graph& graph);
+
+  // With a `control`, the run stops at the deadline, publishes every local
+  // optimum it leaves and, instead of stopping on a stall, restarts from the
+  // shared incumbent when that one is shorter.
+  TourResult Run(const TabuParameters& params, size_t thread_count,
+                 SearchControl* control = nullptr) const;
+
+ private:
+  enum class MoveKind { kNone, kOrOpt, kSwap };
+
+  struct Move {
+    MoveKind kind = MoveKind::kNone;
+    TourCost delta;     // change of the tour cost
+    size_t length = 0;  // or-opt: segment length
+    size_t target = 0;  // or-opt: insert after this position; swap: other position
+  };
+
+  Move BestMoveAt(const std::vector<int>& tour,
+                  const std::vector<size_t>& tabu_until,
+                  size_t iteration,
+                  size_t position,
+                  const TabuParameters& params) const;
+
+  const Graph& graph_;
+};
+
+}  // namespace lr4
+
+#endif  // LR4_TABU_SOLVER_H
@@ -1,14 +1,40 @@
 #include <cassert>
 #include <cmath>
+#include <cstdio>
+#include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <sstream>
+#include <string>
+#include <vector>
 
+#include "../annealing_solver.h"
 #include "../ant_colony_solver.h"
+#include "../decomposition_solver.h"
+#include "../genetic_solver.h"
 #include "../graph.h"
+#include "../instance_generator.h"
+#include "../local_search.h"
+#include "../perf_counters.h"
+#include "../portfolio_solver.h"
+#include "../solver_metrics.h"
+#include "../statistics.h"
+#include "../tabu_solver.h"
+#include "../trace_recorder.h"
 
+using lr4::AnnealingParameters;
+using lr4::AnnealingSolver;
 using lr4::AntColonyParameters;
 using lr4::AntColonySolver;
+using lr4::DecompositionParameters;
+using lr4::DecompositionSolver;
+using lr4::GeneticParameters;
+using lr4::GeneticSolver;
 using lr4::Graph;
+using lr4::PortfolioParameters;
+using lr4::PortfolioSolver;
+using lr4::TabuParameters;
+using lr4::TabuSolver;
 using lr4::TourResult;
 
 void TestGraphParsing() {
@@ -25,6 +51,262 @@ void TestGraphParsing() {
   assert(canonical.front() == canonical.back());
 }
 
+void TestGraphFromMatrixView() {
+  std::vector<double> weights = {
+      0.0, 1.0, 4.0,
+      1.0, 0.0, 2.0,
+      4.0, 2.0, 0.0,
+  };
+  Graph view = Graph::FromMatrix(weights.data(), 3, {"A", "B", "C"});
+  assert(view.VertexCount() == 3);
+  assert(!view.OwnsWeights());
+  assert(view.IsSymmetric());
+  assert(!view.SymmetryCached());
+  assert(view.Label(2) == "C");
+  weights[0 * 3 + 2] = 5.0;
+  assert(std::fabs(view.Weight(0, 2) - 5.0) < 1e-9);
+  // Symmetry follows the caller's buffer, so tours are not reversed on a
+  // view that became directed.
+  assert(!view.IsSymmetric());
+  assert((view.CanonicalizeTour({0, 2, 1, 0}) == std::vector<int>{0, 2, 1, 0}));
+  Graph copy = view;
+  assert(copy.Row(1) == view.Row(1));
+  Graph owned = Graph::FromAdjacency({"x", "y"}, {{0.0, 3.0}, {7.0, 0.0}});
+  Graph owned_copy = owned;
+  assert(owned_copy.OwnsWeights());
+  assert(owned_copy.SymmetryCached());
+  Graph adopted = Graph::FromWeights({0.0, 2.0, 3.0, 0.0}, 2);
+  assert(adopted.OwnsWeights() && adopted.SymmetryCached() && !adopted.IsSymmetric());
+  assert(owned_copy.Row(0) != owned.Row(0));
+  assert(!owned_copy.IsSymmetric());
+
+  weights[0 * 3 + 2] = 4.0;
+  assert(view.IsSymmetric());
+  assert((view.CanonicalizeTour({0, 2, 1, 0}) == std::vector<int>{0, 1, 2, 0}));
+  AntColonySolver solver(view);
+  AntColonyParameters params;
+  params.ants = 10;
+  params.iterations = 10;
+  TourResult result = solver.RunSequential(params);
+  assert(std::fabs(result.best_length - 7.0) < 1e-9);
+}
+
+void TestTsplibMetricGraph() {
+  std::istringstream input(R"(NAME : square
+TYPE : TSP
+DIMENSION : 4
+EDGE_WEIGHT_TYPE : EUC_2D
+NODE_COORD_SECTION
+1 0 0
+2 3 4
+3 1 1
+4 0 10
+EOF
+)");
+  Graph graph = Graph::FromTsplib(input);
+  assert(graph.VertexCount() == 4);
+  assert(graph.GetMetric() == Graph::Metric::kEuclidean);
+  assert(graph.Row(0) == nullptr);
+  assert(graph.IsSymmetric());
+  assert(graph.Label(1) == "2");
+  assert(graph.Weight(0, 1) == 5.0);
+  assert(graph.Weight(0, 2) == 1.0);
+  assert(graph.Weight(2, 2) == 0.0);
+  Graph ceil = Graph::FromCoordinates(Graph::Metric::kCeilEuclidean, {0, 1}, {0, 1});
+  assert(ceil.Weight(0, 1) == 2.0);
+  Graph att = Graph::FromCoordinates(Graph::Metric::kAtt, {0, 30}, {0, 40});
+  assert(att.Weight(1, 0) == 16.0);   // sqrt(250) = 15.8 rounds to 16
+  Graph geo = Graph::FromCoordinates(Graph::Metric::kGeographic, {38.24, 39.57}, {20.42, 26.15});
+  assert(geo.Weight(0, 1) == geo.Weight(1, 0) && geo.Weight(0, 1) > 400.0);
+
+  std::istringstream explicit_input(R"(TYPE: ATSP
+DIMENSION: 3
+EDGE_WEIGHT_TYPE: EXPLICIT
+EDGE_WEIGHT_FORMAT: FULL_MATRIX
+EDGE_WEIGHT_SECTION
+9999 1 7
+2 9999 1
+1 8 9999
+)");
+  Graph matrix = Graph::FromTsplib(explicit_input);
+  assert(matrix.OwnsWeights() && !matrix.IsSymmetric());
+  assert(matrix.Weight(0, 0) == 0.0 && matrix.Weight(2, 0) == 1.0);
+
+  // Neighbour lists must not change the greedy tour, and rows must agree
+  // with single weights.
+  const size_t n = 200;
+  std::vector<double> xs(n);
+  std::vector<double> ys(n);
+  for (size_t i = 0; i < n; ++i) {
+    xs[i] = static_cast<double>((i * 7919) % 1000);
+    ys[i] = static_cast<double>((i * 104729) % 1000);
+  }
+  Graph points = Graph::FromCoordinates(Graph::Metric::kEuclidean, xs, ys);
+  std::vector<double> row(n);
+  points.FillRow(17, row.data());
+  for (size_t to = 0; to < n; ++to) {
+    assert(row[to] == points.Weight(17, to));
+  }
+  std::vector<int> plain = lr4::GreedyTour(points);
+  points.BuildNeighbours(8, 2);
+  assert(points.NeighbourCount() == 8);
+  const int* nearest = points.Neighbours(17);
+  for (size_t k = 1; k < 8; ++k) {
+    assert(row[static_cast<size_t>(nearest[k - 1])] <= row[static_cast<size_t>(nearest[k])]);
+  }
+  assert(lr4::GreedyTour(points) == plain);
+  Graph part = points.Subgraph({3, 17, 40});
+  assert(part.GetMetric() == Graph::Metric::kEuclidean);
+  assert(part.Weight(0, 1) == points.Weight(3, 17));
+}
+
+void TestInstanceGenerator() {
+  lr4::GeneratorParameters params;
+  params.vertices = 300;
+  params.max_out_degree = 5;
+  Graph sparse = lr4::GenerateSparseDigraph(params, 1);
+  Graph sparse_parallel = lr4::GenerateSparseDigraph(params, 4);
+  for (size_t from = 0; from < params.vertices; ++from) {
+    size_t degree = 0;
+    for (size_t to = 0; to < params.vertices; ++to) {
+      assert(sparse.Weight(from, to) == sparse_parallel.Weight(from, to));
+      degree += from != to && sparse.Weight(from, to) != Graph::kInfinity;
+    }
+    assert(degree >= 1 && degree <= params.max_out_degree);
+    assert(sparse.Weight(from, (from + 1) % params.vertices) < Graph::kInfinity);
+  }
+  assert(sparse.Label(7) == "v7");
+  assert(sparse.SymmetryCached());
+
+  Graph uniform = lr4::GenerateUniformEuclidean(params, 3);
+  assert(uniform.GetMetric() == Graph::Metric::kEuclidean);
+  params.vertices = 2500;
+  Graph clustered = lr4::GenerateClusteredEuclidean(params, 1);
+  Graph clustered_parallel = lr4::GenerateClusteredEuclidean(params, 3);
+  assert(clustered.Weight(0, 2499) == clustered_parallel.Weight(0, 2499));
+
+  Graph skewed = lr4::PerturbAsymmetric(uniform, 0.2, 7, 2);
+  assert(skewed.OwnsWeights() && !skewed.IsSymmetric());
+  const double base = uniform.Weight(3, 9);
+  assert(skewed.Weight(3, 9) >= 0.8 * base && skewed.Weight(3, 9) <= 1.2 * base);
+}
+
+void TestBinaryGraphFile() {
+  const std::string path = "binary_graph_test.lr4g";
+  Graph original = Graph::FromAdjacency({"a", "bb", "c"},
+                                        {{0.0, 2.0, Graph::kInfinity},
+                                         {3.0, 0.0, 1.0},
+                                         {4.0, 5.0, 0.0}});
+  original.SaveBinary(path);
+  {
+    Graph mapped = Graph::FromBinaryFile(path);
+    assert(!mapped.OwnsWeights());
+    assert(!mapped.IsSymmetric());
+    assert(mapped.Label(1) == "bb");
+    Graph copy = mapped;
+    mapped = Graph{};
+    for (size_t from = 0; from < 3; ++from) {
+      for (size_t to = 0; to < 3; ++to) {
+        assert(copy.Weight(from, to) == original.Weight(from, to));
+      }
+    }
+  }
+  Graph points = Graph::FromCoordinates(Graph::Metric::kGeographic, {38.24, 39.57}, {20.42, 26.15});
+  points.SaveBinary(path);
+  Graph loaded = Graph::FromBinaryFile(path);
+  assert(loaded.GetMetric() == Graph::Metric::kGeographic);
+  assert(loaded.Weight(0, 1) == points.Weight(0, 1));
+  std::remove(path.c_str());
+}
+
+void TestSampleStatistics() {
+  std::vector<double> samples = {10.0, 12.0, 11.0, 13.0, 9.0, 11.5, 10.5, 80.0};
+  lr4::SampleSummary summary = lr4::Summarize(samples);
+  assert(summary.count == samples.size());
+  assert(summary.min == 9.0 && summary.max == 80.0);
+  assert(std::fabs(summary.median - 11.25) < 1e-9);
+  assert(summary.outliers == 1);
+  assert(summary.median_ci_low <= summary.median && summary.median <= summary.median_ci_high);
+  assert(summary.median_ci_high < 80.0);
+  lr4::SampleSummary again = lr4::Summarize(samples);
+  assert(again.median_ci_low == summary.median_ci_low);
+  std::vector<double> sorted = {1.0, 2.0, 3.0, 4.0};
+  assert(std::fabs(lr4::Percentile(sorted, 0.5) - 2.5) < 1e-9);
+  assert(lr4::Percentile(sorted, 1.0) == 4.0);
+
+  std::vector<lr4::TracePoint> trace = {{1.0, 30.0}, {4.0, 20.0}, {9.0, 10.0}};
+  assert(lr4::TimeToTarget(trace, 20.0) == 4.0);
+  assert(std::isinf(lr4::TimeToTarget(trace, 5.0)));
+  assert(std::isinf(lr4::QualityAt(trace, 0.5)));
+  assert(lr4::QualityAt(trace, 8.0) == 20.0);
+
+  std::vector<size_t> threads = {1, 2, 4, 8};
+  std::vector<double> speedups;
+  std::vector<double> scaled;
+  for (size_t p : threads) {
+    speedups.push_back(1.0 / (0.1 + 0.9 / static_cast<double>(p)));
+    scaled.push_back(static_cast<double>(p) - 0.2 * static_cast<double>(p - 1));
+  }
+  assert(std::fabs(lr4::AmdahlSerialFraction(threads, speedups) - 0.1) < 1e-9);
+  assert(std::fabs(lr4::GustafsonSerialFraction(threads, scaled) - 0.2) < 1e-9);
+  assert(lr4::AmdahlSerialFraction({1}, {1.0}) == 0.0);
+}
+
+void TestBaselineComparison() {
+  assert((lr4::SplitCsvRow("a,,b,") == std::vector<std::string>{"a", "", "b", ""}));
+  assert((lr4::SplitCsvRow("x\r") == std::vector<std::string>{"x"}));
+
+  // Counter cells at the end stay empty when counters are off; the rows
+  // must still load.
+  std::istringstream csv(
+      "vertices,variant,threads,median_ms,median_ci_low_ms,median_ci_high_ms,ipc\n"
+      "100,sequential,1,10.0,9.5,10.5,\n"
+      "100,parallel,4,4.0,3.8,4.2,1.5\n"
+      "\n");
+  lr4::Baseline baseline = lr4::ParseBaseline(csv);
+  assert(baseline.size() == 2);
+  const lr4::BaselineEntry& sequential = baseline.at({100, "sequential", 1});
+  assert(sequential.median_ms == 10.0 && sequential.median_ci_high_ms == 10.5);
+
+  // Only the columns that are read are required.
+  std::istringstream reordered(
+      "median_ci_high_ms,threads,median_ms,variant,median_ci_low_ms,vertices,extra\n"
+      "3,2,2.5,parallel,2,50\n");
+  assert(lr4::ParseBaseline(reordered).count({50, "parallel", 2}) == 1);
+
+  auto rejects = [](const std::string& text) {
+    std::istringstream input(text);
+    try {
+      lr4::ParseBaseline(input);
+    } catch (const std::runtime_error&) {
+      return true;
+    }
+    return false;
+  };
+  assert(rejects(""));
+  assert(rejects("vertices,variant,threads,median_ms\n"));
+  assert(rejects("vertices,variant,threads,median_ms,median_ci_low_ms,median_ci_high_ms\n"
+                 "100,sequential,1,10.0\n"));
+
+  lr4::SampleSummary slower;
+  slower.median = 12.0;
+  slower.median_ci_low = 11.8;
+  slower.median_ci_high = 12.2;
+  lr4::MedianChange change = lr4::CompareMedians(sequential, slower, 0.05);
+  assert(std::fabs(change.change - 0.2) < 1e-9);
+  assert(std::fabs(change.low - (11.8 / 10.5 - 1.0)) < 1e-9);
+  assert(change.regression && !change.improvement);
+  // The same slowdown within overlapping intervals is not a regression.
+  assert(!lr4::CompareMedians(sequential, slower, 0.2).regression);
+  lr4::SampleSummary faster;
+  faster.median = 5.0;
+  faster.median_ci_low = 4.9;
+  faster.median_ci_high = 5.1;
+  change = lr4::CompareMedians(sequential, faster, 0.05);
+  assert(change.improvement && !change.regression);
+  assert(!lr4::CompareMedians(lr4::BaselineEntry{}, slower, 0.05).regression);
+}
+
 void TestSequentialSolver() {
   std::istringstream input(R"(digraph G {
     A -> B [weight=1];
@@ -47,6 +329,26 @@ void TestSequentialSolver() {
   TourResult result = solver.RunSequential(params);
   assert(std::isfinite(result.best_length));
   assert(!result.best_paths.empty());
+  assert(!result.trace.empty());
+  assert(result.trace.back().best_length == result.best_length);
+  const double construction = result.phase_ms[static_cast<size_t>(lr4::Phase::kConstruction)];
+  assert(construction > 0.0 && construction <= result.elapsed_ms * 1.01);
+  assert(result.thread_phase_ms.empty());
+  assert(result.iterations.empty());
+
+  params.iteration_stats = true;
+  for (const TourResult& run : {solver.RunSequential(params), solver.RunParallel(params, 3)}) {
+    assert(run.iterations.size() == params.iterations);
+    for (size_t k = 0; k < run.iterations.size(); ++k) {
+      const lr4::IterationStats& stats = run.iterations[k];
+      assert(stats.iteration == k && stats.dead_ends == 0);
+      assert(stats.iteration_best <= stats.mean && stats.mean <= stats.worst);
+      assert(stats.best_so_far <= stats.iteration_best);
+      assert(k == 0 || stats.best_so_far <= run.iterations[k - 1].best_so_far);
+      // Three vertices leave two candidate edges per row.
+      assert(stats.branching >= 1.0 && stats.branching <= 2.0);
+    }
+  }
 }
 
 void TestParallelSolverAgreement() {
@@ -75,12 +377,296 @@ void TestParallelSolverAgreement() {
   assert(!seq.best_paths.empty());
   assert(!par.best_paths.empty());
   assert(std::fabs(seq.best_length - par.best_length) < 1e-3);
+  assert(par.thread_phase_ms.size() == 4);
+  // One join per iteration; every worker found an ant and took the lock once.
+  assert(par.sync.barriers == params.iterations);
+  assert(par.sync.barrier_idle_ms.size() == 4);
+  assert(par.sync.lock_acquisitions == 4 * params.iterations);
+  assert(par.sync.contended_acquisitions <= par.sync.lock_acquisitions);
+  assert(seq.sync.barriers == 0);
+
+  // Every worker is observed once per iteration, without changing the result.
+  struct CountingObserver : lr4::WorkerObserver {
+    std::atomic<int> starts[4] = {};
+    std::atomic<int> stops[4] = {};
+    void OnWorkerStart(size_t worker) override { ++starts[worker]; }
+    void OnWorkerStop(size_t worker) override { ++stops[worker]; }
+  } observer;
+  TourResult observed = solver.RunParallel(params, 4, nullptr, &observer);
+  assert(std::fabs(observed.best_length - par.best_length) < 1e-9);
+  for (size_t t = 0; t < 4; ++t) {
+    assert(observer.starts[t] == static_cast<int>(params.iterations));
+    assert(observer.stops[t] == static_cast<int>(params.iterations));
+  }
+}
+
+void TestPerfCounters() {
+  lr4::CounterValues a;
+  assert(!a.Any() && a.Ipc() < 0.0);
+  a.values = {100.0, 250.0, 1.0, 2.0, 3.0, 0.0};
+  lr4::CounterValues b = a;
+  b.values[static_cast<size_t>(lr4::Counter::kLlcMisses)] = -1.0;
+  a += b;
+  assert(std::fabs(a.Get(lr4::Counter::kCycles) - 200.0) < 1e-9);
+  assert(!a.Has(lr4::Counter::kLlcMisses));
+  assert(std::fabs(a.Scaled(0.5).Ipc() - 2.5) < 1e-9);
+
+  // Counters may be unavailable here (containers, perf_event_paranoid); the
+  // class must then report missing values instead of failing.
+  lr4::PerfCounters counters(false);
+  counters.Start();
+  volatile double sink = 0.0;
+  for (int i = 0; i < 100000; ++i) {
+    sink = sink + std::sqrt(static_cast<double>(i));
+  }
+  lr4::CounterValues values = counters.Stop();
+  assert(values.Any() == counters.Available() || !counters.Error().empty());
+  if (values.Has(lr4::Counter::kInstructions)) {
+    assert(values.Get(lr4::Counter::kInstructions) > 0.0);
+  }
+}
+
+// Complete undirected graph over n points evenly spaced on a unit circle; the
+// optimal tour walks the polygon.
+Graph BuildCircleGraph(size_t n) {
+  std::ostringstream dot;
+  dot << "graph G {\n";
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = i + 1; j < n; ++j) {
+      double angle_i = 2.0 * M_PI * static_cast<double>(i) / static_cast<double>(n);
+      double angle_j = 2.0 * M_PI * static_cast<double>(j) / static_cast<double>(n);
+      double distance = std::hypot(std::cos(angle_i) - std::cos(angle_j),
+                                   std::sin(angle_i) - std::sin(angle_j));
+      dot << "  p" << i << " -- p" << j << " [weight=" << distance << "];\n";
+    }
+  }
+  dot << "}\n";
+  std::istringstream input(dot.str());
+  return Graph::FromGraphviz(input);
+}
+
+bool IsHamiltonianCycle(const std::vector<int>& tour, size_t n) {
+  if (tour.size() != n + 1 || tour.front() != tour.back()) {
+    return false;
+  }
+  std::vector<int> sorted(tour.begin(), tour.end() - 1);
+  std::sort(sorted.begin(), sorted.end());
+  for (size_t i = 0; i < n; ++i) {
+    if (sorted[i] != static_cast<int>(i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void TestDecompositionSolver() {
+  const size_t n = 120;
+  Graph graph = BuildCircleGraph(n);
+  DecompositionSolver solver(graph);
+  DecompositionParameters params;
+  params.cluster_size = 20;
+  params.colony.seed = 7;
+  TourResult result = solver.Run(params, 4);
+  const double perimeter = 2.0 * static_cast<double>(n) * std::sin(M_PI / static_cast<double>(n));
+  assert(std::isfinite(result.best_length));
+  assert(result.best_paths.size() == 1);
+  assert(IsHamiltonianCycle(result.best_paths.front(), n));
+  assert(result.best_length < 1.5 * perimeter);
+}
+
+void TestAnnealingSolver() {
+  const size_t n = 40;
+  Graph graph = BuildCircleGraph(n);
+  AnnealingSolver solver(graph);
+  AnnealingParameters params;
+  params.steps = 40000;
+  params.exchange_interval = 500;
+  params.seed = 11;
+  TourResult result = solver.Run(params, 3);
+  const double perimeter = 2.0 * static_cast<double>(n) * std::sin(M_PI / static_cast<double>(n));
+  assert(result.best_paths.size() == 1);
+  assert(IsHamiltonianCycle(result.best_paths.front(), n));
+  assert(result.best_length < 1.05 * perimeter);
+}
+
+void TestGeneticSolver() {
+  const size_t n = 16;
+  Graph graph = BuildCircleGraph(n);
+  GeneticSolver solver(graph);
+  const double perimeter = 2.0 * static_cast<double>(n) * std::sin(M_PI / static_cast<double>(n));
+  for (lr4::Crossover crossover : {lr4::Crossover::kOrder, lr4::Crossover::kEdgeRecombination}) {
+    GeneticParameters params;
+    params.population = 48;
+    params.generations = 150;
+    params.crossover = crossover;
+    params.seed = 5;
+    TourResult result = solver.Run(params, 4);
+    TourResult repeated = solver.Run(params, 2);
+    assert(result.best_paths.size() == 1);
+    assert(IsHamiltonianCycle(result.best_paths.front(), n));
+    assert(result.best_length < 1.1 * perimeter);
+    assert(std::fabs(result.best_length - repeated.best_length) < 1e-9);
+  }
+}
+
+void TestDirectedTourOrientation() {
+  // The only cheap cycle is A -> D -> C -> B -> A; its reverse A > B > C > D
+  // sorts first but costs 40, so it must never be reported.
+  const double x = 10.0;
+  Graph graph = Graph::FromAdjacency({"A", "B", "C", "D"}, {{0.0, x, x, 1.0},
+                                                            {1.0, 0.0, x, x},
+                                                            {x, 1.0, 0.0, x},
+                                                            {x, x, 1.0, 0.0}});
+  assert(!graph.IsSymmetric());
+  const std::vector<int> expected = {0, 3, 2, 1, 0};
+  assert(graph.CanonicalizeTour({2, 1, 0, 3, 2}) == expected);
+  AntColonySolver solver(graph);
+  AntColonyParameters params;
+  params.ants = 10;
+  params.iterations = 20;
+  TourResult seq = solver.RunSequential(params);
+  TourResult par = solver.RunParallel(params, 2);
+  for (const TourResult* result : {&seq, &par}) {
+    assert(std::fabs(result->best_length - 4.0) < 1e-9);
+    assert(result->best_paths.size() == 1);
+    assert(result->best_paths.front() == expected);
+  }
+  Graph symmetric = Graph::FromAdjacency({"A", "B", "C"},
+                                         {{0.0, 1.0, 2.0}, {1.0, 0.0, 3.0}, {2.0, 3.0, 0.0}});
+  assert((symmetric.CanonicalizeTour({0, 2, 1, 0}) == std::vector<int>{0, 1, 2, 0}));
+}
+
+void TestTabuSolverDirected() {
+  // Directed ring a0 -> a1 -> ... -> a11 -> a0 of cheap edges; every other
+  // edge is expensive, so the ring is the unique optimum.
+  const size_t n = 12;
+  std::ostringstream dot;
+  dot << "digraph G {\n";
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = 0; j < n; ++j) {
+      if (i != j) {
+        double weight = (j == (i + 1) % n) ? 1.0 : 10.0 + static_cast<double>((i * 7 + j * 3) % 5);
+        dot << "  a" << i << " -> a" << j << " [weight=" << weight << "];\n";
+      }
+    }
+  }
+  dot << "}\n";
+  std::istringstream input(dot.str());
+  Graph graph = Graph::FromGraphviz(input);
+  TabuSolver solver(graph);
+  TabuParameters params;
+  params.iterations = 2000;
+  params.window = 6;
+  params.parallel_threshold = 4;
+  TourResult result = solver.Run(params, 3);
+  TourResult sequential = solver.Run(params, 1);
+  assert(result.best_paths.size() == 1);
+  assert(IsHamiltonianCycle(result.best_paths.front(), n));
+  assert(std::fabs(result.best_length - static_cast<double>(n)) < 1e-9);
+  assert(result.best_paths == sequential.best_paths);
+  assert(result.sync.barriers > 0);
+  assert(result.sync.barrier_idle_ms.size() == 3);
+  assert(sequential.sync.barriers == 0);
+}
+
+void TestPortfolioSolver() {
+  const size_t n = 30;
+  Graph graph = BuildCircleGraph(n);
+  PortfolioSolver solver(graph);
+  PortfolioParameters params;
+  params.time_limit_ms = 300.0;
+  params.colony.ants = 16;
+  TourResult result = solver.Run(params, 6);
+  const double perimeter = 2.0 * static_cast<double>(n) * std::sin(M_PI / static_cast<double>(n));
+  assert(result.best_paths.size() == 1);
+  assert(IsHamiltonianCycle(result.best_paths.front(), n));
+  assert(result.best_length < 1.1 * perimeter);
+  assert(result.elapsed_ms < 5000.0);
+
+  // Members run with an unbounded iteration count; collecting per-iteration
+  // stats must not try to reserve that many rows.
+  params.time_limit_ms = 100.0;
+  params.colony.iteration_stats = true;
+  result = solver.Run(params, 2);
+  assert(IsHamiltonianCycle(result.best_paths.front(), n));
+  assert(std::isfinite(result.best_length));
+}
+
+void TestTraceRecorder() {
+  Graph graph = BuildCircleGraph(12);
+  AntColonySolver solver(graph);
+  AntColonyParameters params;
+  params.ants = 8;
+  params.iterations = 3;
+  lr4::TraceRecorder recorder(4);
+  lr4::TraceRecorder::Install(&recorder);
+  solver.RunParallel(params, 2);
+  lr4::TraceRecorder::Install(nullptr);
+  std::ostringstream json;
+  recorder.WriteJson(json);
+  const std::string text = json.str();
+  assert(text.find("\"name\": \"aco worker 1\"") != std::string::npos);
+  assert(text.find("\"name\": \"join\", \"ph\": \"X\"") != std::string::npos);
+  // Each track keeps its last 4 spans; the main track saw 12.
+  assert(recorder.Dropped() > 0);
+  // A track keeps its label: a run with another label gets its own row, a
+  // later run with the same label comes back to it.
+  lr4::TraceRecorder labels(2);
+  const size_t first = labels.AcquireTrack("aco");
+  labels.ReleaseTrack(first);
+  const size_t other = labels.AcquireTrack("annealing");
+  assert(other != first);
+  assert(labels.AcquireTrack("aco") == first);
+  const size_t busy = labels.AcquireTrack("aco");
+  assert(busy != first && busy != other);
+  // Without an installed recorder nothing is leased or recorded.
+  lr4::TraceTracks idle("idle", 2);
+  assert(idle.recorder() == nullptr);
+}
+
+void TestSolverMetrics() {
+  Graph graph = BuildCircleGraph(10);
+  AntColonySolver solver(graph);
+  AntColonyParameters params;
+  params.ants = 6;
+  params.iterations = 4;
+  lr4::SolverMetrics metrics;
+  lr4::SolverMetrics::Install(&metrics);
+  solver.RunSequential(params);
+  solver.RunParallel(params, 2);
+  solver.RunParallel(params, 2);
+  lr4::SolverMetrics::Install(nullptr);
+  solver.RunSequential(params);
+  std::ostringstream out;
+  metrics.WritePrometheus(out);
+  const std::string text = out.str();
+  assert(text.find("lr4_solves_total{variant=\"sequential\"} 1\n") != std::string::npos);
+  assert(text.find("lr4_solves_total{variant=\"parallel\"} 2\n") != std::string::npos);
+  assert(text.find("lr4_ants_total{variant=\"parallel\"} 48\n") != std::string::npos);
+  assert(text.find("lr4_solve_duration_seconds_bucket{variant=\"parallel\",le=\"+Inf\"} 2\n") !=
+         std::string::npos);
+  assert(text.find("# TYPE lr4_solve_duration_seconds histogram") != std::string::npos);
 }
 
 int main() {
   TestGraphParsing();
+  TestGraphFromMatrixView();
+  TestTsplibMetricGraph();
+  TestInstanceGenerator();
+  TestBinaryGraphFile();
+  TestSampleStatistics();
+  TestBaselineComparison();
   TestSequentialSolver();
   TestParallelSolverAgreement();
+  TestPerfCounters();
+  TestTraceRecorder();
+  TestSolverMetrics();
+  TestDecompositionSolver();
+  TestAnnealingSolver();
+  TestGeneticSolver();
+  TestDirectedTourOrientation();
+  TestTabuSolverDirected();
+  TestPortfolioSolver();
   std::cout << "PASSED" << std::endl;
   return 0;
 }
@@ -0,0 +1,158 @@
+#include "trace_recorder.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <utility>
+
+namespace lr4 {
+
+std::atomic<TraceRecorder*> TraceRecorder::active_{nullptr};
+
+TraceRecorder::TraceRecorder(size_t spans_per_track)
+    : capacity_(spans_per_track == 0 ? 1 : spans_per_track),
+      epoch_(Clock::now()),
+      tracks_(kMaxTracks) {}
+
+void TraceRecorder::Install(TraceRecorder* recorder) {
+  active_.store(recorder, std::memory_order_release);
+}
+
+size_t TraceRecorder::AcquireTrack(const std::string& label) {
+  std::lock_guard<std::mutex> lock(lease_mutex_);
+  // A track that carried this label before keeps its row; otherwise the
+  // first never-used track, so a row never changes meaning.
+  size_t fresh = kMaxTracks;
+  for (size_t track = 0; track < tracks_.size(); ++track) {
+    Track& target = tracks_[track];
+    if (target.leased) {
+      continue;
+    }
+    if (target.label == label) {
+      target.leased = true;
+      return track;
+    }
+    if (fresh == kMaxTracks && target.label.empty()) {
+      fresh = track;
+    }
+  }
+  if (fresh != kMaxTracks) {
+    Track& target = tracks_[fresh];
+    target.leased = true;
+    target.label = label;
+    target.ring.resize(capacity_);
+  }
+  return fresh;
+}
+
+void TraceRecorder::ReleaseTrack(size_t track) {
+  if (track >= tracks_.size()) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(lease_mutex_);
+  tracks_[track].leased = false;
+}
+
+void TraceRecorder::Record(size_t track, const char* name, Clock::time_point begin,
+                           Clock::time_point end) {
+  if (track >= tracks_.size()) {
+    overflow_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  Track& target = tracks_[track];
+  Span& span = target.ring[target.written % capacity_];
+  span.name = name;
+  span.begin_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(begin - epoch_).count();
+  span.duration_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+  ++target.written;
+}
+
+size_t TraceRecorder::Dropped() const {
+  size_t dropped = overflow_.load(std::memory_order_relaxed);
+  for (const Track& track : tracks_) {
+    if (track.written > capacity_) {
+      dropped += static_cast<size_t>(track.written - capacity_);
+    }
+  }
+  return dropped;
+}
+
+void TraceRecorder::WriteJson(std::ostream& out) const {
+  auto quoted = [](const std::string& text) {
+    std::string result = "\"";
+    for (char ch : text) {
+      if (ch == '"' || ch == '\\') {
+        result.push_back('\\');
+      }
+      result.push_back(static_cast<unsigned char>(ch) < 0x20 ? ' ' : ch);
+    }
+    result.push_back('"');
+    return result;
+  };
+  out << std::fixed << std::setprecision(3);
+  out << "{\"displayTimeUnit\": \"ms\", \"otherData\": {\"dropped_spans\": " << Dropped()
+      << "},\n\"traceEvents\": [\n";
+  out << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"args\": {\"name\": \"lr4\"}}";
+  for (size_t track = 0; track < tracks_.size(); ++track) {
+    const Track& source = tracks_[track];
+    if (source.written == 0) {
+      continue;
+    }
+    out << ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << track
+        << ", \"args\": {\"name\": " << quoted(source.label) << "}}";
+    out << ",\n{\"name\": \"thread_sort_index\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << track
+        << ", \"args\": {\"sort_index\": " << track << "}}";
+    const uint64_t kept = std::min<uint64_t>(source.written, capacity_);
+    for (uint64_t k = source.written - kept; k < source.written; ++k) {
+      const Span& span = source.ring[k % capacity_];
+      out << ",\n{\"name\": " << quoted(span.name) << ", \"ph\": \"X\", \"pid\": 1, \"tid\": "
+          << track << ", \"ts\": " << static_cast<double>(span.begin_ns) / 1000.0
+          << ", \"dur\": " << static_cast<double>(span.duration_ns) / 1000.0 << "}";
+    }
+  }
+  out << "\n]}\n";
+}
+
+TraceTracks::TraceTracks(const std::string& label, size_t workers)
+    : recorder_(TraceRecorder::Active()) {
+  if (recorder_ == nullptr) {
+    return;
+  }
+  ids_.push_back(recorder_->AcquireTrack(label));
+  for (size_t t = 0; t < workers; ++t) {
+    ids_.push_back(recorder_->AcquireTrack(label + " worker " + std::to_string(t)));
+  }
+}
+
+TraceTracks::~TraceTracks() {
+  for (size_t id : ids_) {
+    recorder_->ReleaseTrack(id);
+  }
+}
+
+ScopedTraceFile::ScopedTraceFile(std::string path) : path_(std::move(path)) {
+  if (!path_.empty()) {
+    TraceRecorder::Install(&recorder_);
+  }
+}
+
+ScopedTraceFile::~ScopedTraceFile() {
+  if (path_.empty()) {
+    return;
+  }
+  TraceRecorder::Install(nullptr);
+  std::ofstream out(path_);
+  if (!out) {
+    std::cerr << "Не удалось записать трассировку в " << path_ << std::endl;
+    return;
+  }
+  recorder_.WriteJson(out);
+  std::cout << "Трассировка сохранена в " << path_;
+  if (recorder_.Dropped() > 0) {
+    std::cout << " (потеряно интервалов: " << recorder_.Dropped() << ")";
+  }
+  std::cout << std::endl;
+}
+
+}  // namespace lr4
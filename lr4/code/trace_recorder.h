@@ -0,0 +1,139 @@
+#ifndef LR4_TRACE_RECORDER_H
+#define LR4_TRACE_RECORDER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace lr4 {
+
+// Spans of solver execution in the Chrome trace-event format, viewable in
+// chrome://tracing or Perfetto. Spans go to tracks (rows in the viewer), each
+// with its own ring buffer; a solver run leases tracks for itself and its
+// workers through TraceTracks, so every track has a single writer at a time
+// and recording takes no locks. Workers of successive iterations are ordered
+// by thread creation and join. A full ring overwrites its oldest spans.
+class TraceRecorder {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  static constexpr size_t kMaxTracks = 256;
+
+  explicit TraceRecorder(size_t spans_per_track = size_t{1} << 15);
+
+  // Makes `recorder` the one solvers record into; nullptr stops recording.
+  static void Install(TraceRecorder* recorder);
+  static TraceRecorder* Active() { return active_.load(std::memory_order_acquire); }
+
+  // Leases a free track that already carries `label`, or else the lowest
+  // unused track, names it and allocates its ring; kMaxTracks if none is
+  // left. A track keeps its label for good, so every row of the trace holds
+  // the spans of one kind of run. Takes a lock, once per solver run.
+  size_t AcquireTrack(const std::string& label);
+  void ReleaseTrack(size_t track);
+
+  // `name` must outlive the recorder, e.g. a string literal.
+  void Record(size_t track, const char* name, Clock::time_point begin, Clock::time_point end);
+
+  // Spans lost to ring overwrites or to runs that found no free track.
+  size_t Dropped() const;
+
+  void WriteJson(std::ostream& out) const;
+
+ private:
+  struct Span {
+    const char* name;
+    int64_t begin_ns;
+    int64_t duration_ns;
+  };
+
+  struct Track {
+    std::vector<Span> ring;  // allocated by the first lease
+    uint64_t written = 0;
+    bool leased = false;
+    std::string label;
+  };
+
+  static std::atomic<TraceRecorder*> active_;
+
+  const size_t capacity_;
+  const Clock::time_point epoch_;
+  std::vector<Track> tracks_;
+  std::atomic<size_t> overflow_{0};
+  std::mutex lease_mutex_;
+};
+
+// Tracks leased from the active recorder for one solver run: track 0 for the
+// calling thread, track 1 + t for worker t. Everything is a no-op when no
+// recorder is installed.
+class TraceTracks {
+ public:
+  TraceTracks(const std::string& label, size_t workers);
+  ~TraceTracks();
+
+  TraceTracks(const TraceTracks&) = delete;
+  TraceTracks& operator=(const TraceTracks&) = delete;
+
+  TraceRecorder* recorder() const { return recorder_; }
+  size_t Main() const { return ids_.empty() ? TraceRecorder::kMaxTracks : ids_[0]; }
+  size_t Worker(size_t worker) const {
+    return worker + 1 < ids_.size() ? ids_[worker + 1] : TraceRecorder::kMaxTracks;
+  }
+
+ private:
+  TraceRecorder* recorder_;
+  std::vector<size_t> ids_;
+};
+
+// Records the time from construction to End() or destruction as a span.
+class TraceSpan {
+ public:
+  TraceSpan(TraceRecorder* recorder, size_t track, const char* name)
+      : recorder_(recorder), track_(track), name_(name) {
+    if (recorder_ != nullptr) {
+      begin_ = TraceRecorder::Clock::now();
+    }
+  }
+  ~TraceSpan() { End(); }
+
+  TraceSpan(const TraceSpan&) = delete;
+  TraceSpan& operator=(const TraceSpan&) = delete;
+
+  void End() {
+    if (recorder_ != nullptr) {
+      recorder_->Record(track_, name_, begin_, TraceRecorder::Clock::now());
+      recorder_ = nullptr;
+    }
+  }
+
+ private:
+  TraceRecorder* recorder_;
+  size_t track_;
+  const char* name_;
+  TraceRecorder::Clock::time_point begin_;
+};
+
+// Installs a recorder for the lifetime of the object and writes its trace
+// to `path` on destruction; an empty path disables tracing.
+class ScopedTraceFile {
+ public:
+  explicit ScopedTraceFile(std::string path);
+  ~ScopedTraceFile();
+
+  ScopedTraceFile(const ScopedTraceFile&) = delete;
+  ScopedTraceFile& operator=(const ScopedTraceFile&) = delete;
+
+ private:
+  std::string path_;
+  TraceRecorder recorder_;
+};
+
+}  // namespace lr4
+
+#endif  // LR4_TRACE_RECORDER_H